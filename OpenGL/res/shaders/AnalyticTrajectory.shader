@@ -0,0 +1,34 @@
+#shader vertex
+#version 330 core
+
+// one instance per ball, one vertex per sample; the exact solution of
+// dv/dt = gravity - k v (AdvanceAnalytic in sim/Physics.h), captured by transform feedback
+layout(location = 0) in vec3 launchPosition; // relative to the generator's origin
+layout(location = 1) in vec4 launchVelocity; // xyz velocity, w = k = beta / mass
+
+#feedback trajectoryPoint
+out vec3 trajectoryPoint;
+
+uniform vec3 gravity;
+uniform float timeStep;
+
+// e^x - 1 without the cancellation of exp(x) - 1 near zero
+float Expm1(float x)
+{
+	return abs(x) < 1.0e-3 ? x * (1.0 + x * (0.5 + x / 6.0)) : exp(x) - 1.0;
+}
+
+void main()
+{
+	float t = float(gl_VertexID) * timeStep;
+	float k = launchVelocity.w;
+	vec3 velocity = launchVelocity.xyz;
+	if (k == 0.0)
+	{
+		trajectoryPoint = launchPosition + t * velocity + (0.5 * t * t) * gravity;
+		return;
+	}
+	vec3 terminal = gravity / k;
+	float decay = Expm1(-k * t);
+	trajectoryPoint = launchPosition + t * terminal - (decay / k) * (velocity - terminal);
+};
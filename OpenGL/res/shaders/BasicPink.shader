@@ -5,13 +5,11 @@ layout(location = 0) in vec3 aPos;
 
 out vec2 TexCoord;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "include/Transform.glsl"
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	gl_Position = ObjectToClip(aPos);
 };
 
 #shader fragment
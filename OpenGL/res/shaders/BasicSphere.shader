@@ -6,14 +6,13 @@ layout(location = 1) in vec2 aTexCoord;
 
 out vec2 TexCoord;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "include/Transform.glsl"
+uniform float texFlipY; // 1.0 when the texture rows are stored top row first
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0);
-	TexCoord = aTexCoord;
+	gl_Position = ObjectToClip(aPos);
+	TexCoord = vec2(aTexCoord.x, mix(aTexCoord.y, 1.0 - aTexCoord.y, texFlipY));
 };
 
 #shader fragment
@@ -0,0 +1,28 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec3 aPos;
+
+#include "include/Transform.glsl"
+
+// points are stored relative to their chunk origin (sim/Trajectory.h), one chunk
+// per slot of the pool buffer (renderer/TrajectoryBuffer.h); CHUNK_POINTS and
+// POOL_SLOTS are defined by Application.cpp through SetShaderDefine
+uniform vec3 slotOffsets[POOL_SLOTS]; // origin of the chunk in each slot minus camera position
+
+void main()
+{
+	gl_Position = ObjectToClip(aPos + slotOffsets[min(gl_VertexID / CHUNK_POINTS, POOL_SLOTS - 1)]);
+};
+
+#shader fragment
+#version 330 core
+
+out vec4 FragColor;
+
+uniform vec4 ourColor;
+
+void main()
+{
+	FragColor = ourColor;
+};
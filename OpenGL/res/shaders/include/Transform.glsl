@@ -0,0 +1,9 @@
+uniform mat4 model;
+uniform mat4 view;       // camera at the origin: the renderer works camera-relative
+uniform mat4 projection;
+uniform vec3 originOffset; // object origin minus camera position, subtracted in double on the CPU
+
+vec4 ObjectToClip(vec3 position)
+{
+	return projection * view * (model * vec4(position, 1.0) + vec4(originOffset, 0.0));
+}
@@ -2,12 +2,24 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
 #include <vector>
-
-#include "stb_image.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <cstring>
+#include <cmath>
+
+#include "renderer/Renderer.h"
+#include "renderer/Shader.h"
+#include "renderer/ShaderQueue.h"
+#include "renderer/ShaderWatcher.h"
+#include "renderer/TextureLoader.h"
+#include "renderer/TrajectoryBuffer.h"
+#include "renderer/TrajectoryGenerator.h"
+#include "sim/Frustum.h"
+#include "sim/SimulationThread.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -37,104 +49,82 @@ float fov   = 45.0f;
 // timing
 float deltaTime = 0.0f; // time between current frame and last frame
 float lastFrame = 0.0f;
+double simTime = 0.0; // simulated seconds, driving the camera path and sphere spin
+const float SIMULATION_DT = 1.0f / 120.0f; // fixed physics step, run on its own thread
+
+// benchmark mode (--benchmark N): fixed timestep, no vsync, deterministic camera
+const float BENCHMARK_DT = 1.0f / 60.0f;
+const unsigned int GPU_QUERY_COUNT = 4; // timer queries in flight, avoids stalling on results
 
 float sphereRadius = 0.7f;
 
-static void GLClearError()
-{
-    while (glGetError() != GL_NO_ERROR);
-}
+// chunk slots of the trajectory pool, POOL_SLOTS in Trajectory.shader; two full trajectories fit without eviction
+const unsigned int TRAJECTORY_POOL_SLOTS = 32;
+// samples per GPU-generated trajectory (--analytic), at the simulation step
+const unsigned int ANALYTIC_POINTS = 2400;
 
-static void GLCheckError()
+static glm::vec3 ToGlm(const Vec3& v)
 {
-    while (GLenum error = glGetError())
-    {
-        std::cout << "[OpenGL Error] (" << error << ")" << std::endl;
-    }
+    return glm::vec3(v.x, v.y, v.z);
 }
 
-struct ShaderProgramSource
+// narrows a double offset, e.g. an object position minus the camera position
+static glm::vec3 ToGlm(const Vec3D& v)
 {
-    std::string VertexSource;
-    std::string FragmentSource;
-};
-
-static ShaderProgramSource ParseShader(const std::string& filepath) 
-{
-    std::ifstream stream(filepath);
-
-    enum class ShaderType
-    {
-        NONE = -1, VERTEX = 0, FRAGMENT = 1
-    };
-
-    std::string line;
-    std::stringstream ss[2];
-    ShaderType type = ShaderType::NONE;
-    while (getline(stream, line)) {
-        if (line.find("#shader") != std::string::npos) 
-        {
-            if (line.find("vertex") != std::string::npos)
-                type = ShaderType::VERTEX;
-            else if (line.find("fragment") != std::string::npos)
-                type = ShaderType::FRAGMENT;
-        }
-        else
-        {
-            ss[(int)type] << line << '\n';
-        }
-    }
-
-    return { ss[0].str(), ss[1].str() };
+    return glm::vec3((float)v.x, (float)v.y, (float)v.z);
 }
 
-static unsigned int CompileShader(unsigned int type, const std::string& source)
+static double Percentile(const std::vector<double>& sorted, double p)
 {
-    unsigned int id = glCreateShader(type);
-    const char* src = source.c_str();
-    glShaderSource(id, 1, &src, nullptr);
-    glCompileShader(id);
-
-    int result;
-    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-    if (result == GL_FALSE)
-    {
-        int length;
-        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)alloca(length * sizeof(char));
-        glGetShaderInfoLog(id, length, &length, message);
-        std::cout << "Failed to compile shader!" << std::endl;
-        std::cout << message << std::endl;
-        glDeleteShader(id);
-        return 0;
-    }
-
-    return id;
+    if (sorted.empty())
+        return 0.0;
+    size_t index = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
 }
 
-static unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+static void PrintBenchmarkReport(std::vector<double> frameTimesMs, double totalWallMs, double totalCpuMs, double totalGpuMs, const glm::vec3& finalPosition)
 {
-    unsigned int program = glCreateProgram();
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
-
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-    glValidateProgram(program);
-
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-
-    return program;
+    std::sort(frameTimesMs.begin(), frameTimesMs.end());
+    double totalFrameMs = 0.0;
+    for (double t : frameTimesMs)
+        totalFrameMs += t;
+
+    std::cout << "[Benchmark] frames:     " << frameTimesMs.size() << std::endl;
+    std::cout << "[Benchmark] fps:        " << (totalFrameMs > 0.0 ? frameTimesMs.size() * 1000.0 / totalFrameMs : 0.0) << std::endl;
+    std::cout << "[Benchmark] frame ms:   p50 " << Percentile(frameTimesMs, 50.0)
+              << "  p90 " << Percentile(frameTimesMs, 90.0)
+              << "  p99 " << Percentile(frameTimesMs, 99.0)
+              << "  max " << (frameTimesMs.empty() ? 0.0 : frameTimesMs.back()) << std::endl;
+    std::cout << "[Benchmark] total wall: " << totalWallMs << " ms" << std::endl;
+    std::cout << "[Benchmark] total CPU:  " << totalCpuMs << " ms" << std::endl;
+    std::cout << "[Benchmark] total GPU:  " << totalGpuMs << " ms" << std::endl;
+    std::cout << "[Benchmark] final position: " << finalPosition.x << " " << finalPosition.y << " " << finalPosition.z << std::endl;
 }
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 
-int main(void)
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
 
+    /* Command line */
+    unsigned int benchmarkFrames = 0;
+    const char* stateLogPath = nullptr; // per-step state hashes, to check runs are bit-identical
+    unsigned int analyticBalls = 0;     // extra balls whose drag trajectories are generated on the GPU
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc)
+            benchmarkFrames = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--state-log") == 0 && i + 1 < argc)
+            stateLogPath = argv[++i];
+        else if (std::strcmp(argv[i], "--analytic") == 0 && i + 1 < argc)
+            analyticBalls = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+    }
+
+    /* Start decoding textures while the window and shaders are set up */
+    TextureLoader textureLoader;
+    unsigned int marsTexture = textureLoader.Request("res/textures/mars.jpg");
+
     /* Initialize the library */
     if (!glfwInit())
         return -1;
@@ -158,6 +148,10 @@ int main(void)
     // glfwSetCursorPosCallback(window, mouse_callback);
     // glfwSetScrollCallback(window, scroll_callback);
 
+    /* Benchmark runs uncapped */
+    if (benchmarkFrames > 0)
+        glfwSwapInterval(0);
+
     /* Initialize glew */
     if (glewInit() != GLEW_OK)
         std::cout << "Error" << std::endl;
@@ -165,13 +159,19 @@ int main(void)
     /* Print GL version */
     std::cout << glGetString(GL_VERSION) << std::endl;
 
-    /* Shader creation and linking */
+    /* Shader creation and linking, checked right before first use (see programReady below) */
+    // Trajectory.shader indexes the chunk pool with these
+    SetShaderDefine("CHUNK_POINTS", std::to_string(Trajectory::CHUNK_POINTS));
+    SetShaderDefine("POOL_SLOTS", std::to_string(TRAJECTORY_POOL_SLOTS));
+    ShaderBuildQueue shaderQueue;
     // pink
-    ShaderProgramSource sourcePink = ParseShader("res/shaders/BasicPink.shader");
-    unsigned int shaderPink = CreateShader(sourcePink.VertexSource, sourcePink.FragmentSource);
+    unsigned int shaderPink = shaderQueue.Submit("res/shaders/BasicPink.shader");
     // sphere
-    ShaderProgramSource sourceSphere = ParseShader("res/shaders/BasicSphere.shader");
-    unsigned int shaderSphere = CreateShader(sourceSphere.VertexSource, sourceSphere.FragmentSource);
+    unsigned int shaderSphere = shaderQueue.Submit("res/shaders/BasicSphere.shader");
+    // trajectories, offset per chunk
+    unsigned int shaderTrajectory = shaderQueue.Submit("res/shaders/Trajectory.shader");
+    // closed-form trajectories by transform feedback, only when asked for
+    unsigned int shaderAnalytic = analyticBalls > 0 ? shaderQueue.Submit("res/shaders/AnalyticTrajectory.shader") : 0;
 
 
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -412,26 +412,15 @@ int main(void)
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO_sphere);
 
     /* Texture source */
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load("res/textures/mars.jpg", &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
+    textureLoader.WaitAndUpload();
+    unsigned int texture = textureLoader.Texture(marsTexture);
+    float texFlipY = textureLoader.Origin(marsTexture) == TextureOrigin::TOP_LEFT ? 1.0f : 0.0f;
+    // first used right away by Generate; a failed program falls back to CPU generation there
+    if (shaderAnalytic && !shaderQueue.Finish(shaderAnalytic))
     {
-        std::cout << "Failed to load texture" << std::endl;
+        glDeleteProgram(shaderAnalytic);
+        shaderAnalytic = 0;
     }
-    stbi_image_free(data);
 
     glBufferData(GL_ARRAY_BUFFER, sizeof(sphere_coords), sphere_coords, GL_STATIC_DRAW);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sphere_indices), sphere_indices, GL_STATIC_DRAW);
@@ -461,155 +450,290 @@ int main(void)
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)0);
     glBindVertexArray(0);
 
-    // trajectory
-    unsigned int VAO_trajectory, VBO_trajectory;
-    glGenVertexArrays(1, &VAO_trajectory);
-    glGenBuffers(1, &VBO_trajectory);
-    glBindVertexArray(VAO_trajectory);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_trajectory);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)0);
-    glBindVertexArray(0);
+    // physics, published to this thread as snapshots
+    SimulationThread simulation(Vec3D(0.0, 10.0, 0.0), Vec3D(5.0, 0.0, 0.0), benchmarkFrames > 0 ? BENCHMARK_DT : SIMULATION_DT);
+    simulation.RecordStateHashes(stateLogPath != nullptr);
+    const SimulationSnapshot* snapshot = &simulation.Latest();
 
-    // trajectory_nf
-    unsigned int VAO_trajectory_nf, VBO_trajectory_nf;
-    glGenVertexArrays(1, &VAO_trajectory_nf);
-    glGenBuffers(1, &VBO_trajectory_nf);
-    glBindVertexArray(VAO_trajectory_nf);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_trajectory_nf);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)0);
-    glBindVertexArray(0);
+    // trajectories: chunks in a shared pool buffer, points appended as the simulation publishes them
+    TrajectoryChunkPool trajectoryPool(TRAJECTORY_POOL_SLOTS);
+    TrajectoryBuffer trajectory(trajectoryPool);
+    TrajectoryBuffer trajectoryNf(trajectoryPool);
+    unsigned int trajectoryChunksDrawn = 0;
 
 
-    // physics
-    std::vector<float> trajectory_coords;
-    std::vector<float> trajectory_nf_coords; // nf = no friction
-    glm::vec3 positions = glm::vec3(0.0f, 10.0f, 0.0f);
-    glm::vec3 velocity = glm::vec3(5.0f, 0.0f, 0.0f);
-    glm::vec3 acceleration = glm::vec3(0.0f, 0.0f, 0.0f);
+    // projection matrix
+    glm::mat4 projection = glm::perspective(fov, (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+    // model for trajectory
+    glm::mat4 model = glm::mat4(1.0f);
 
-    glm::vec3 positions_nf = glm::vec3(0.0f, 10.0f, 0.0f);
-    glm::vec3 velocity_nf = glm::vec3(5.0f, 0.0f, 0.0f);
-    glm::vec3 acceleration_nf = glm::vec3(0.0f, 0.0f, 0.0f);
+    // uniforms that never change; set when a program becomes usable and again whenever a shader is hot-reloaded
+    auto usable = [&](unsigned int program) { return program != 0 && !shaderQueue.IsPending(program); };
+    auto setStaticUniforms = [&]()
+    {
+        if (usable(shaderPink))
+        {
+            glUseProgram(shaderPink);
+            glUniformMatrix4fv(glGetUniformLocation(shaderPink, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+            glUniformMatrix4fv(glGetUniformLocation(shaderPink, "model"), 1, GL_FALSE, glm::value_ptr(model));
+        }
+        if (usable(shaderSphere))
+        {
+            glUseProgram(shaderSphere);
+            glUniformMatrix4fv(glGetUniformLocation(shaderSphere, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+            glUniform1f(glGetUniformLocation(shaderSphere, "texFlipY"), texFlipY);
+        }
+        if (usable(shaderTrajectory))
+        {
+            glUseProgram(shaderTrajectory);
+            glUniformMatrix4fv(glGetUniformLocation(shaderTrajectory, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+            glUniformMatrix4fv(glGetUniformLocation(shaderTrajectory, "model"), 1, GL_FALSE, glm::value_ptr(model));
+        }
+    };
 
-    glm::vec3 g_accel = glm::vec3(0.0f, -5.0f, 0.0f);
-    const float beta = 0.5f;
-    const float mass = 1.0f;
-    const float k = beta / mass;
+    /* Called before a program is bound each frame. While its build is still
+       running (KHR_parallel_shader_compile) the draws using it are skipped;
+       once the driver reports it complete it is finished and gets its static
+       uniforms. A failed build is deleted and zeroed, so its draws stay
+       skipped until a hot reload replaces it. Benchmark runs wait instead,
+       so every timed frame draws everything. */
+    auto programReady = [&](unsigned int& program)
+    {
+        if (program == 0)
+            return false;
+        if (!shaderQueue.IsPending(program))
+            return true;
+        if (benchmarkFrames == 0 && !shaderQueue.IsReady(program))
+            return false;
+        if (!shaderQueue.Finish(program))
+        {
+            glDeleteProgram(program);
+            program = 0;
+            return false;
+        }
+        setStaticUniforms();
+        return true;
+    };
 
+    // --analytic N: a fan of launches from the start point, sampled on the GPU once
+    TrajectoryGenerator analyticTrajectories;
+    if (analyticBalls > 0)
+    {
+        PhysicsParams params;
+        std::vector<AnalyticLaunch> launches(analyticBalls);
+        for (unsigned int b = 0; b < analyticBalls; b++)
+        {
+            double angle = 6.283185307179586 * b / analyticBalls;
+            launches[b].Position = Vec3D(0.0, 10.0, 0.0);
+            launches[b].Velocity = Vec3D(5.0 * std::cos(angle), 2.0 + 3.0 * (b % 5), 5.0 * std::sin(angle));
+            launches[b].K = params.Beta / params.Mass;
+        }
+        analyticTrajectories.Generate(shaderAnalytic, launches, params.Gravity, SIMULATION_DT, ANALYTIC_POINTS);
+    }
 
-    unsigned int trajectory_count = 0;
+    // hot reload of edited shaders, off in benchmark runs
+    ShaderWatcher shaderWatcher;
+    if (benchmarkFrames == 0)
+    {
+        shaderWatcher.Watch("res/shaders/BasicPink.shader", &shaderPink);
+        shaderWatcher.Watch("res/shaders/BasicSphere.shader", &shaderSphere);
+        shaderWatcher.Watch("res/shaders/Trajectory.shader", &shaderTrajectory);
+        shaderWatcher.Start();
+    }
 
-    // projection matrix
-    glm::mat4 projection = glm::perspective(fov, (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-    glUseProgram(shaderPink);
-    glUniformMatrix4fv(glGetUniformLocation(shaderPink, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    glUseProgram(shaderSphere);
-    glUniformMatrix4fv(glGetUniformLocation(shaderSphere, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    // model for trajectory
-    glm::mat4 model = glm::mat4(1.0f);
-    glUseProgram(shaderPink);
-    glUniformMatrix4fv(glGetUniformLocation(shaderPink, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    // benchmark timing
+    std::vector<double> frameTimesMs;
+    frameTimesMs.reserve(benchmarkFrames);
+    double totalWallMs = 0.0;
+    double totalCpuMs = 0.0; // process CPU time, all threads
+    double totalGpuMs = 0.0;
+    unsigned int gpuQueries[GPU_QUERY_COUNT];
+    unsigned int framesRendered = 0;
+    if (benchmarkFrames > 0)
+        glGenQueries(GPU_QUERY_COUNT, gpuQueries);
+    auto benchmarkStart = std::chrono::steady_clock::now();
+    std::clock_t benchmarkCpuStart = std::clock();
+
+    // benchmark runs step once per frame on this thread to stay deterministic
+    if (benchmarkFrames == 0)
+        simulation.Start();
 
     /* Loop until the user closes the window */
     while (!glfwWindowShouldClose(window))
     {
+        auto frameStart = std::chrono::steady_clock::now();
+
         // per-frame time logic
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        // physics
-        glm::vec3 fricton_accel = -k * velocity;
-        acceleration = fricton_accel + g_accel;
-        velocity += deltaTime * acceleration;
-        positions += deltaTime * velocity;
-        // nf
-        acceleration_nf = g_accel;
-        velocity_nf += deltaTime * acceleration_nf;
-        positions_nf += deltaTime * velocity_nf;
-
-        if (trajectory_count < 1000000) {
-            trajectory_coords.push_back(positions.x);
-            trajectory_coords.push_back(positions.y);
-            trajectory_coords.push_back(positions.z);
-
-            trajectory_nf_coords.push_back(positions_nf.x);
-            trajectory_nf_coords.push_back(positions_nf.y);
-            trajectory_nf_coords.push_back(positions_nf.z);
-
-            trajectory_count++;
+        if (benchmarkFrames > 0)
+        {
+            deltaTime = BENCHMARK_DT;
+            simulation.Step();
+        }
+        else
+        {
+            float currentFrame = glfwGetTime();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
         }
-        
+
+        // physics: latest state the simulation has published
+        snapshot = &simulation.Latest();
+        simTime = snapshot->Time;
+
+        // camera-relative rendering: the camera sits at the origin and everything is placed by its
+        // offset from the camera, taken in double, so distant flights draw without float jitter
+        Vec3D ball = snapshot->Ball;
+        Vec3D eye(ball.x - 1.0, ball.y + 10.0, 5.0 + simTime * 2.0);
+        glm::vec3 positions = ToGlm(ball - eye);
 
         /* Input */
         processInput(window);
 
-        // model for sphere
+        if (shaderWatcher.Update())
+            setStaticUniforms();
+        bool pinkReady = programReady(shaderPink);
+        bool sphereReady = programReady(shaderSphere);
+        bool trajectoryReady = programReady(shaderTrajectory);
+
+        // model for sphere, placed by originOffset
         glm::mat4 model_sphere = glm::mat4(1.0f);
-        model_sphere = glm::translate(model_sphere, positions);
-        model_sphere = glm::rotate(model_sphere, (float)glfwGetTime() * glm::radians(180.0f), glm::vec3(0.5f, 1.0f, 0.0f));
+        model_sphere = glm::rotate(model_sphere, (float)std::fmod(simTime, 2.0) * glm::radians(180.0f), glm::vec3(0.5f, 1.0f, 0.0f));
         model_sphere = glm::scale(model_sphere, glm::vec3(sphereRadius));
-        glUseProgram(shaderSphere);
-        glUniformMatrix4fv(glGetUniformLocation(shaderSphere, "model"), 1, GL_FALSE, glm::value_ptr(model_sphere));
 
         // view
-        cameraPos = glm::vec3(positions.x - 1.0f, positions.y + 10.0f, 5.0f + (float)glfwGetTime() * 2.0f);
-        glm::mat4 view = glm::lookAt(cameraPos, positions, cameraUp);
-        glUseProgram(shaderPink);
-        glUniformMatrix4fv(glGetUniformLocation(shaderPink, "view"), 1, GL_FALSE, &view[0][0]);
-        glUseProgram(shaderSphere);
-        glUniformMatrix4fv(glGetUniformLocation(shaderSphere, "view"), 1, GL_FALSE, &view[0][0]);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), positions, cameraUp);
+        if (pinkReady)
+        {
+            glUseProgram(shaderPink);
+            glUniformMatrix4fv(glGetUniformLocation(shaderPink, "view"), 1, GL_FALSE, &view[0][0]);
+            glUniform3fv(glGetUniformLocation(shaderPink, "originOffset"), 1, glm::value_ptr(ToGlm(-eye))); // the floor is in world space
+        }
+        if (sphereReady)
+        {
+            glUseProgram(shaderSphere);
+            glUniformMatrix4fv(glGetUniformLocation(shaderSphere, "model"), 1, GL_FALSE, glm::value_ptr(model_sphere));
+            glUniform3fv(glGetUniformLocation(shaderSphere, "originOffset"), 1, glm::value_ptr(positions));
+            glUniformMatrix4fv(glGetUniformLocation(shaderSphere, "view"), 1, GL_FALSE, &view[0][0]);
+        }
+        if (trajectoryReady)
+        {
+            glUseProgram(shaderTrajectory);
+            glUniformMatrix4fv(glGetUniformLocation(shaderTrajectory, "view"), 1, GL_FALSE, &view[0][0]);
+        }
+
+        // culling in the same camera-relative space the shaders draw in
+        glm::mat4 clip = projection * view;
+        Frustum frustum(glm::value_ptr(clip));
         
 
 
         /* Render here */
+        if (benchmarkFrames > 0)
+        {
+            // collect the query issued GPU_QUERY_COUNT frames ago before reusing it
+            unsigned int query = gpuQueries[framesRendered % GPU_QUERY_COUNT];
+            if (framesRendered >= GPU_QUERY_COUNT)
+            {
+                GLuint64 elapsedNs = 0;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNs);
+                totalGpuMs += elapsedNs / 1.0e6;
+            }
+            glBeginQuery(GL_TIME_ELAPSED, query);
+        }
         glClearColor(0.6f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // draw floor
-        glBindVertexArray(VAO_floor);
-        glUseProgram(shaderPink);
-        glUniform4f(glGetUniformLocation(shaderPink, "ourColor"), 0.3f, 0.3f, 0.3f, 1.0f);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
-
-        // draw trajectory
-        glBindVertexArray(VAO_trajectory);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO_trajectory);
-        glBufferData(GL_ARRAY_BUFFER, trajectory_coords.size() * sizeof(float), &trajectory_coords[0], GL_DYNAMIC_DRAW);
-        glUseProgram(shaderPink);
-        glUniform4f(glGetUniformLocation(shaderPink, "ourColor"), 0.0f, 0.0f, 1.0f, 1.0f);
-        glDrawArrays(GL_LINE_STRIP, 0, trajectory_count);
-        glBindVertexArray(0);
-
-        // draw trajectory_nf
-        glBindVertexArray(VAO_trajectory_nf);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO_trajectory_nf);
-        glBufferData(GL_ARRAY_BUFFER, trajectory_nf_coords.size() * sizeof(float), &trajectory_nf_coords[0], GL_DYNAMIC_DRAW);
-        glUseProgram(shaderPink);
-        glUniform4f(glGetUniformLocation(shaderPink, "ourColor"), 0.87f, 0.2f, 0.84f, 1.0f); // pink
-        glDrawArrays(GL_LINE_STRIP, 0, trajectory_count);
-        glBindVertexArray(0);
-
-        // draw sphere
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glBindVertexArray(VAO_sphere);
-        glUseProgram(shaderSphere);
-        glDrawElements(GL_TRIANGLES, sizeof(sphere_indices), GL_UNSIGNED_INT, 0);
+        if (pinkReady)
+        {
+            glBindVertexArray(VAO_floor);
+            glUseProgram(shaderPink);
+            glUniform4f(glGetUniformLocation(shaderPink, "ourColor"), 0.3f, 0.3f, 0.3f, 1.0f);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            glBindVertexArray(0);
+        }
+
+        // draw trajectory; points are uploaded even while the program is not ready
+        trajectoryPool.BeginFrame();
+        trajectory.Append(snapshot->Path, snapshot->PathCount);
+        trajectoryNf.Append(snapshot->PathNoFriction, snapshot->PathNoFrictionCount);
+        if (trajectoryReady)
+        {
+            glUseProgram(shaderTrajectory);
+            int slotOffsets = glGetUniformLocation(shaderTrajectory, "slotOffsets");
+            glUniform4f(glGetUniformLocation(shaderTrajectory, "ourColor"), 0.0f, 0.0f, 1.0f, 1.0f);
+            trajectoryChunksDrawn += trajectory.Draw(snapshot->PathOrigins, eye, frustum, slotOffsets);
+
+            // draw trajectory_nf
+            glUniform4f(glGetUniformLocation(shaderTrajectory, "ourColor"), 0.87f, 0.2f, 0.84f, 1.0f); // pink
+            trajectoryChunksDrawn += trajectoryNf.Draw(snapshot->PathNoFrictionOrigins, eye, frustum, slotOffsets);
+        }
+
+        // draw the GPU-generated trajectories
+        if (pinkReady && analyticTrajectories.Balls() > 0)
+        {
+            glUseProgram(shaderPink);
+            glUniform3fv(glGetUniformLocation(shaderPink, "originOffset"), 1, glm::value_ptr(ToGlm(analyticTrajectories.Origin() - eye)));
+            glUniform4f(glGetUniformLocation(shaderPink, "ourColor"), 1.0f, 0.55f, 0.0f, 1.0f);
+            analyticTrajectories.Draw();
+        }
+
+        // draw sphere, unless it is out of view
+        if (sphereReady && frustum.TestSphere(Vec3(positions.x, positions.y, positions.z), sphereRadius))
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glBindVertexArray(VAO_sphere);
+            glUseProgram(shaderSphere);
+            glDrawElements(GL_TRIANGLES, sizeof(sphere_indices), GL_UNSIGNED_INT, 0);
+        }
         
+        if (benchmarkFrames > 0)
+            glEndQuery(GL_TIME_ELAPSED);
 
         /* Swap front and back buffers */
         glfwSwapBuffers(window);
 
         /* Poll for and process events */
         glfwPollEvents();
+
+        if (benchmarkFrames > 0)
+        {
+            double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            frameTimesMs.push_back(frameMs);
+            if (++framesRendered >= benchmarkFrames)
+                break;
+        }
+    }
+
+    if (benchmarkFrames > 0)
+    {
+        // drain the queries still in flight
+        unsigned int pending = std::min(framesRendered, GPU_QUERY_COUNT);
+        for (unsigned int i = framesRendered - pending; i < framesRendered; i++)
+        {
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(gpuQueries[i % GPU_QUERY_COUNT], GL_QUERY_RESULT, &elapsedNs);
+            totalGpuMs += elapsedNs / 1.0e6;
+        }
+        glDeleteQueries(GPU_QUERY_COUNT, gpuQueries);
+        totalWallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - benchmarkStart).count();
+        totalCpuMs = 1000.0 * (std::clock() - benchmarkCpuStart) / CLOCKS_PER_SEC;
+        const SimulationSnapshot& last = simulation.Latest();
+        PrintBenchmarkReport(frameTimesMs, totalWallMs, totalCpuMs, totalGpuMs, ToGlm(last.Ball));
+        std::cout << "[Benchmark] trajectory chunks drawn: " << (framesRendered > 0 ? (double)trajectoryChunksDrawn / framesRendered : 0.0) << " per frame" << std::endl;
     }
 
+    simulation.Stop();
+    if (stateLogPath && !simulation.Hashes().Write(stateLogPath))
+        std::cout << "Failed to write " << stateLogPath << std::endl;
     glDeleteProgram(shaderPink);
     glDeleteProgram(shaderSphere);
+    glDeleteProgram(shaderTrajectory);
+    trajectoryPool.DeleteBuffers();
+    analyticTrajectories.DeleteBuffers();
+    if (shaderAnalytic)
+        glDeleteProgram(shaderAnalytic);
 
     glfwTerminate();
     return 0;
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "sim/ChunkSlots.h"
+
+/* Trajectory chunk pool benchmark: trajectories grow every frame while a
+   camera sweeps back and forth along them, drawing a window of chunks
+   from a pool with fewer slots than chunks, as TrajectoryBuffer does.
+   Reports how often chunks are evicted and written again. --check keeps
+   a CPU copy of the slots, applies every write the tables ask for, and
+   requires each resident chunk's slot to hold exactly that chunk's
+   points, every eviction to pick the least recently drawn chunk, and no
+   chunk drawn in a frame to lose its slot before the frame ends. */
+
+// what the emulated vertex buffer holds for a point: its trajectory and index
+static uint32_t PointId(unsigned int trajectory, unsigned int point)
+{
+    return (uint32_t)trajectory << 24 | point;
+}
+
+struct SlotState
+{
+    const ChunkSlotTable* Owner;
+    unsigned int Chunk;
+    unsigned long long LastDrawn;
+    bool Open;
+};
+
+/* One Prepare against the slots as they were before it: at most one slot
+   changed hands; if one was taken from another chunk, no slot was free
+   and that chunk was the least recently drawn of those not drawn this
+   frame and not open. A chunk left without a slot had none of those. */
+static bool CheckPrepare(const ChunkSlotPool& pool, const std::vector<SlotState>& before, bool placed)
+{
+    unsigned int changed = 0, victim = ChunkSlotPool::NO_SLOT;
+    bool anyFree = false;
+    unsigned long long oldest = ~0ull;
+    for (unsigned int slot = 0; slot < pool.Slots(); slot++)
+    {
+        const SlotState& state = before[slot];
+        if (!state.Owner)
+            anyFree = true;
+        else if (state.LastDrawn != pool.Frame() && !state.Open)
+            oldest = std::min(oldest, state.LastDrawn);
+        if (pool.Owner(slot) != state.Owner || pool.Chunk(slot) != state.Chunk)
+        {
+            changed++;
+            victim = slot;
+        }
+    }
+    if (!placed)
+        return changed == 0 && !anyFree && oldest == ~0ull;
+    if (changed > 1)
+        return false;
+    if (changed == 0 || !before[victim].Owner)
+        return true;
+    return !anyFree && before[victim].LastDrawn == oldest && before[victim].LastDrawn != pool.Frame() && !before[victim].Open;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int trajectoryCount = 2;
+    unsigned int chunksEach = 12;
+    unsigned int slots = 8;
+    unsigned int frames = 768; // with 12 chunks, 2048 points a frame: lengths land on chunk boundaries
+    unsigned int window = 3; // chunks in view besides the newest
+    bool check = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--trajectories") == 0 && i + 1 < argc)
+            trajectoryCount = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--chunks") == 0 && i + 1 < argc)
+            chunksEach = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--slots") == 0 && i + 1 < argc)
+            slots = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--window") == 0 && i + 1 < argc)
+            window = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--check") == 0)
+            check = true;
+    }
+    if (trajectoryCount == 0 || trajectoryCount > 255 || chunksEach == 0 || frames == 0
+        || (unsigned long long)chunksEach * Trajectory::CHUNK_POINTS >= 1u << 24)
+    {
+        std::cout << "need 1-255 trajectories and fewer than " << (1u << 24) / Trajectory::CHUNK_POINTS << " chunks each" << std::endl;
+        return 1;
+    }
+
+    const unsigned int CHUNK = Trajectory::CHUNK_POINTS;
+    const unsigned int totalPoints = chunksEach * CHUNK;
+    // the trajectories fill up over the first half of the run
+    const unsigned int growth = std::max(1u, totalPoints / std::max(1u, frames / 2));
+
+    ChunkSlotPool pool(slots);
+    std::vector<std::unique_ptr<ChunkSlotTable>> tables;
+    for (unsigned int t = 0; t < trajectoryCount; t++)
+        tables.emplace_back(new ChunkSlotTable(pool));
+    std::vector<uint32_t> gpu(check ? (size_t)slots * CHUNK : 0, ~0u);
+    std::vector<ChunkSlotTable::Upload> uploads;
+    std::vector<std::vector<unsigned int>> drawnBy(trajectoryCount);
+
+    unsigned long long written = 0, reuploads = 0, chunksDrawn = 0, missed = 0, corrupt = 0, misplaced = 0, lost = 0, badChoice = 0;
+    auto apply = [&](unsigned int t)
+    {
+        for (const ChunkSlotTable::Upload& upload : uploads)
+        {
+            written += upload.To - upload.From;
+            if (check)
+                for (unsigned int p = upload.From; p < upload.To; p++)
+                    gpu[(size_t)upload.Slot * CHUNK + p % CHUNK] = PointId(t, p);
+        }
+    };
+
+    std::vector<SlotState> before;
+    auto snapshot = [&](std::vector<SlotState>& states)
+    {
+        states.resize(pool.Slots());
+        for (unsigned int slot = 0; slot < pool.Slots(); slot++)
+        {
+            const ChunkSlotTable* owner = pool.Owner(slot);
+            states[slot] = { owner, pool.Chunk(slot), pool.LastDrawn(slot), owner && owner->IsOpen(pool.Chunk(slot)) };
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int frame = 0; frame < frames; frame++)
+    {
+        pool.BeginFrame();
+        for (unsigned int t = 0; t < trajectoryCount; t++)
+        {
+            ChunkSlotTable& table = *tables[t];
+            uploads.clear();
+            table.Append(std::min(totalPoints, (frame + 1) * growth), uploads);
+            apply(t);
+
+            // the camera sweeps back and forth over the chunks, each trajectory at its own phase
+            unsigned int chunks = table.Chunks();
+            double phase = 0.5 + 0.5 * std::sin(frame * 0.05 + t * 1.7);
+            unsigned int center = (unsigned int)(phase * (chunks - 1) + 0.5);
+            std::vector<unsigned int>& drawn = drawnBy[t];
+            drawn.clear();
+            for (unsigned int c = center > window / 2 ? center - window / 2 : 0; c < chunks && drawn.size() < window; c++)
+                drawn.push_back(c);
+            if (std::find(drawn.begin(), drawn.end(), chunks - 1) == drawn.end())
+                drawn.push_back(chunks - 1);
+
+            // like TrajectoryBuffer::Draw, a chunk that gets no slot is skipped this frame
+            uploads.clear();
+            size_t kept = 0;
+            for (unsigned int c : drawn)
+            {
+                if (check)
+                    snapshot(before);
+                bool placed = table.Prepare(c, uploads);
+                if (check && !CheckPrepare(pool, before, placed))
+                    badChoice++;
+                if (placed)
+                    drawn[kept++] = c;
+                else
+                    missed++;
+            }
+            drawn.resize(kept);
+            chunksDrawn += kept;
+            reuploads += uploads.size();
+            apply(t);
+        }
+
+        if (!check)
+            continue;
+        /* After every write of the frame: each resident chunk holds its own
+           points, and whatever was drawn this frame is still resident. */
+        for (unsigned int t = 0; t < trajectoryCount; t++)
+        {
+            const ChunkSlotTable& table = *tables[t];
+            for (unsigned int c = 0; c < table.Chunks(); c++)
+            {
+                unsigned int slot = table.Slot(c);
+                if (slot == ChunkSlotPool::NO_SLOT)
+                {
+                    if (std::find(drawnBy[t].begin(), drawnBy[t].end(), c) != drawnBy[t].end())
+                        lost++;
+                    continue;
+                }
+                if (pool.Owner(slot) != &table || pool.Chunk(slot) != c)
+                {
+                    misplaced++;
+                    continue;
+                }
+                unsigned int first = c * CHUNK, last = std::min(table.Count(), first + CHUNK);
+                for (unsigned int p = first; p < last; p++)
+                {
+                    if (gpu[(size_t)slot * CHUNK + p % CHUNK] != PointId(t, p))
+                    {
+                        corrupt++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[ChunkPoolBench] trajectories: " << trajectoryCount << " x " << chunksEach << " chunks, " << slots << " slots" << std::endl;
+    std::cout << "[ChunkPoolBench] frames:       " << frames << " (" << (ms / frames) << " ms/frame" << (check ? " with --check" : "") << ")" << std::endl;
+    std::cout << "[ChunkPoolBench] chunks drawn: " << (double)chunksDrawn / frames << " per frame, " << missed << " without a slot" << std::endl;
+    std::cout << "[ChunkPoolBench] evictions:    " << pool.Evictions() << ", " << reuploads << " chunks written again" << std::endl;
+    std::cout << "[ChunkPoolBench] points written: " << written << " (" << (double)written / ((double)trajectoryCount * totalPoints) << "x the trajectories)" << std::endl;
+    if (!check)
+        return 0;
+
+    bool exercised = pool.Evictions() > 0 && reuploads > 0;
+    bool ok = exercised && misplaced == 0 && corrupt == 0 && lost == 0 && badChoice == 0;
+    std::cout << "[ChunkPoolBench] check:        " << misplaced << " misplaced, " << corrupt << " corrupt, " << lost << " evicted while drawn, " << badChoice << " wrong victims or misses"
+              << (exercised ? "" : ", eviction and re-upload not exercised") << (ok ? " (ok)" : " (FAILED)") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "sim/BallSystem.h"
+#include "sim/ForceField.h"
+#include "sim/SweepAndPrune.h"
+#include "sim/UniformGrid.h"
+
+/* Ball-ball collision benchmark: N balls launched into a box (or a long
+   thin "line" along x) above the floor, stepped with the uniform grid
+   and/or sweep-and-prune broad phase. --check steps a copy of the scene
+   and compares the pairs each finds against brute force after every
+   step, so sweep-and-prune is checked on its incremental path too. */
+
+// deterministic across platforms, unlike std::rand
+static float Random(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+static void BruteForcePairs(const BallSystem& balls, std::vector<BallPair>& pairs)
+{
+    pairs.clear();
+    for (uint32_t a = 0; a < balls.Size(); a++)
+    {
+        for (uint32_t b = a + 1; b < balls.Size(); b++)
+        {
+            float dx = balls.PosX[b] - balls.PosX[a], dy = balls.PosY[b] - balls.PosY[a], dz = balls.PosZ[b] - balls.PosZ[a];
+            float radii = balls.Radius[a] + balls.Radius[b];
+            if (dx * dx + dy * dy + dz * dz < radii * radii)
+                pairs.push_back({ a, b });
+        }
+    }
+}
+
+static void BuildScene(BallSystem& balls, unsigned int ballCount, float radius, bool line)
+{
+    // about 10% volume fraction: collisions are common but the balls are not packed solid
+    float volume = ballCount * 4.19f * radius * radius * radius / 0.1f;
+    // "line" stretches the same volume 100:1 along x, the direction the demo launches in
+    float side = line ? std::cbrt(volume / 100.0f) : std::cbrt(volume);
+    float length = line ? side * 100.0f : side;
+
+    balls.Clear();
+    balls.Reserve(ballCount);
+    uint32_t seed = 12345;
+    for (unsigned int i = 0; i < ballCount; i++)
+    {
+        Vec3 position(Random(seed) * length, -50.0f + radius + Random(seed) * side, Random(seed) * side);
+        Vec3 velocity(5.0f + Random(seed) * 2.0f - 1.0f, Random(seed) * 2.0f - 1.0f, Random(seed) * 2.0f - 1.0f);
+        balls.Add(position, velocity, radius * (0.5f + 0.5f * Random(seed)), 1.0f);
+    }
+}
+
+static bool SamePairs(std::vector<BallPair> pairs, const std::vector<BallPair>& expected)
+{
+    auto less = [](const BallPair& l, const BallPair& r) { return l.A != r.A ? l.A < r.A : l.B < r.B; };
+    std::sort(pairs.begin(), pairs.end(), less);
+    return pairs.size() == expected.size() && std::equal(pairs.begin(), pairs.end(), expected.begin(),
+        [](const BallPair& l, const BallPair& r) { return l.A == r.A && l.B == r.B; });
+}
+
+/* The same broad phase instances see every step, so after the first full sort
+   sweep-and-prune only repairs its order; both must match brute force each time. */
+static bool CheckPairs(BallSystem balls, unsigned int steps, float dt, bool runGrid, bool runSap)
+{
+    ForceFieldStack forces = DefaultForces(PhysicsParams());
+    GroundPlane ground;
+    UniformGrid stepper, grid;
+    SweepAndPrune sap;
+    std::vector<BallPair> expected, pairs, stepPairs;
+    std::vector<GroundedBall> grounded;
+
+    unsigned int gridMismatches = 0, sapMismatches = 0, incrementalSteps = 0;
+    size_t swaps = 0, totalPairs = 0;
+    for (unsigned int step = 0; step <= steps; step++)
+    {
+        if (step > 0)
+            StepBallSystem(balls, forces, ground, 0.8f, dt, stepper, stepPairs, grounded);
+        BruteForcePairs(balls, expected);
+        totalPairs += expected.size();
+        if (runGrid)
+        {
+            grid.FindPairs(balls, pairs);
+            gridMismatches += SamePairs(pairs, expected) ? 0 : 1;
+        }
+        if (runSap)
+        {
+            sap.FindPairs(balls, pairs);
+            sapMismatches += SamePairs(pairs, expected) ? 0 : 1;
+            if (step > 0 && sap.LastSwaps() < balls.Size())
+            {
+                incrementalSteps++;
+                swaps += sap.LastSwaps();
+            }
+        }
+    }
+
+    std::cout << "[CollisionBench] check:      " << steps + 1 << " steps, " << (double)totalPairs / (steps + 1) << " pairs/step" << std::endl;
+    if (runGrid)
+        std::cout << "[CollisionBench] check grid: " << (gridMismatches ? "MISMATCH on " : "matches brute force on all ") << (gridMismatches ? gridMismatches : steps + 1) << " steps" << std::endl;
+    if (runSap)
+        std::cout << "[CollisionBench] check sap:  " << (sapMismatches ? "MISMATCH on " : "matches brute force on all ") << (sapMismatches ? sapMismatches : steps + 1)
+                  << " steps (" << incrementalSteps << " incremental, " << swaps << " insertion moves)" << std::endl;
+    // a check that never took the incremental path, or never reordered anything, proves little
+    bool exercised = !runSap || steps == 0 || (incrementalSteps > 0 && swaps > 0);
+    if (!exercised)
+        std::cout << "[CollisionBench] check sap:  incremental order repair was not exercised" << std::endl;
+    return gridMismatches == 0 && sapMismatches == 0 && exercised;
+}
+
+static double Run(const char* name, BallSystem balls, BroadPhase& broadPhase, unsigned int steps, float dt)
+{
+    ForceFieldStack forces = DefaultForces(PhysicsParams());
+    GroundPlane ground;
+    std::vector<BallPair> pairs;
+    std::vector<GroundedBall> grounded;
+
+    size_t totalPairs = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < steps; i++)
+        totalPairs += StepBallSystem(balls, forces, ground, 0.8f, dt, broadPhase, pairs, grounded);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[CollisionBench] " << name << " ms/step:    " << (steps ? ms / steps : 0.0) << std::endl;
+    std::cout << "[CollisionBench] " << name << " pairs/step: " << (steps ? (double)totalPairs / steps : 0.0) << std::endl;
+    return ms;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int ballCount = 100000;
+    unsigned int steps = 100;
+    float radius = 0.7f;
+    float dt = 1.0f / 120.0f;
+    bool check = false;
+    unsigned int checkSteps = 300;
+    bool line = false;
+    bool runGrid = true, runSap = true;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--balls") == 0 && i + 1 < argc)
+            ballCount = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+            steps = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--radius") == 0 && i + 1 < argc)
+            radius = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--dt") == 0 && i + 1 < argc)
+            dt = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+            line = std::strcmp(argv[++i], "line") == 0;
+        else if (std::strcmp(argv[i], "--broadphase") == 0 && i + 1 < argc)
+        {
+            i++;
+            runGrid = std::strcmp(argv[i], "sap") != 0;
+            runSap = std::strcmp(argv[i], "grid") != 0;
+        }
+        else if (std::strcmp(argv[i], "--check") == 0)
+            check = true;
+        else if (std::strcmp(argv[i], "--check-steps") == 0 && i + 1 < argc)
+            checkSteps = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+    }
+
+    BallSystem balls;
+    BuildScene(balls, ballCount, radius, line);
+    std::cout << "[CollisionBench] balls:      " << ballCount << (line ? " (line)" : " (box)") << std::endl;
+    std::cout << "[CollisionBench] steps:      " << steps << std::endl;
+
+    std::unique_ptr<BroadPhase> grid = CreateBroadPhase(BroadPhaseType::GRID);
+    std::unique_ptr<BroadPhase> sap = CreateBroadPhase(BroadPhaseType::SWEEP_AND_PRUNE);
+
+    if (check && !CheckPairs(balls, checkSteps, dt, runGrid, runSap))
+        return 1;
+
+    double gridMs = runGrid ? Run("grid", balls, *grid, steps, dt) : 0.0;
+    double sapMs = runSap ? Run("sap ", balls, *sap, steps, dt) : 0.0;
+    if (runGrid && runSap && sapMs > 0.0)
+        std::cout << "[CollisionBench] grid/sap:   " << gridMs / sapMs << "x" << std::endl;
+    return 0;
+}
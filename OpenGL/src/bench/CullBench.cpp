@@ -0,0 +1,132 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "sim/BallSystem.h"
+#include "sim/Frustum.h"
+
+/* Frustum culling benchmark: cost per object of the batched (SSE) and
+   one-at-a-time tests, for chunk boxes and for the balls of a
+   BallSystem, seen from a camera at the origin like the renderer's.
+   --check verifies that both paths agree exactly. */
+
+static float Random(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// column-major projection * view for a camera at the origin looking down -z, as glm::perspective builds it
+static void ClipMatrix(float fovY, float aspect, float zNear, float zFar, float* m)
+{
+    float f = 1.0f / std::tan(0.5f * fovY);
+    std::memset(m, 0, 16 * sizeof(float));
+    m[0] = f / aspect;
+    m[5] = f;
+    m[10] = -(zFar + zNear) / (zFar - zNear);
+    m[11] = -1.0f;
+    m[14] = -2.0f * zFar * zNear / (zFar - zNear);
+}
+
+template <typename F>
+static double TimePerObject(size_t count, unsigned int iterations, F&& cull)
+{
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int n = 0; n < iterations; n++)
+        sink += cull();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 12345)
+        std::cout << sink << std::endl; // keep the work observable
+    return ms * 1.0e6 / ((double)iterations * count);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int count = 1000000;
+    unsigned int iterations = 20;
+    bool check = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+            count = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--check") == 0)
+            check = true;
+    }
+
+    float clip[16];
+    ClipMatrix(0.785398f, 1280.0f / 720.0f, 0.1f, 100.0f, clip);
+    Frustum frustum(clip);
+
+    // boxes the size of trajectory chunks, and balls, scattered around the camera
+    uint32_t seed = 12345;
+    std::vector<float> cx(count), cy(count), cz(count), ex(count), ey(count), ez(count);
+    std::vector<Aabb> boxes(count);
+    BallSystem balls;
+    balls.Reserve(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        Vec3 corner(Random(seed) * 400.0f - 200.0f, Random(seed) * 400.0f - 200.0f, Random(seed) * 400.0f - 200.0f);
+        boxes[i] = { corner, corner + Vec3(Random(seed) * 40.0f, Random(seed) * 40.0f, Random(seed) * 40.0f) };
+        // center and half extent exactly as TestBox derives them
+        cx[i] = 0.5f * (boxes[i].Min.x + boxes[i].Max.x);
+        cy[i] = 0.5f * (boxes[i].Min.y + boxes[i].Max.y);
+        cz[i] = 0.5f * (boxes[i].Min.z + boxes[i].Max.z);
+        ex[i] = 0.5f * (boxes[i].Max.x - boxes[i].Min.x);
+        ey[i] = 0.5f * (boxes[i].Max.y - boxes[i].Min.y);
+        ez[i] = 0.5f * (boxes[i].Max.z - boxes[i].Min.z);
+        balls.Add(Vec3(Random(seed) * 400.0f - 200.0f, Random(seed) * 400.0f - 200.0f, Random(seed) * 400.0f - 200.0f), Vec3(), 0.2f + Random(seed), 1.0f);
+    }
+
+    std::vector<unsigned char> visible(count), single(count);
+    size_t visibleBoxes = frustum.CullBoxes(cx.data(), cy.data(), cz.data(), ex.data(), ey.data(), ez.data(), count, visible.data());
+    std::cout << "[CullBench] objects: " << count << (FrustumSimdAvailable() ? " (SSE)" : " (scalar build)") << std::endl;
+    std::cout << "[CullBench] boxes visible:   " << visibleBoxes << std::endl;
+    std::cout << "[CullBench] boxes batched:   " << TimePerObject(count, iterations, [&]()
+    {
+        return frustum.CullBoxes(cx.data(), cy.data(), cz.data(), ex.data(), ey.data(), ez.data(), count, visible.data());
+    }) << " ns/box" << std::endl;
+    std::cout << "[CullBench] boxes one by one: " << TimePerObject(count, iterations, [&]()
+    {
+        size_t n = 0;
+        for (unsigned int i = 0; i < count; i++)
+            n += single[i] = frustum.TestBox(boxes[i]) ? 1 : 0;
+        return n;
+    }) << " ns/box" << std::endl;
+    size_t boxMismatches = 0;
+    for (unsigned int i = 0; i < count; i++)
+        boxMismatches += visible[i] != single[i];
+
+    std::vector<unsigned char> visibleBalls(count), singleBalls(count);
+    std::cout << "[CullBench] balls visible:   " << frustum.CullSpheres(balls.PosX.data(), balls.PosY.data(), balls.PosZ.data(), balls.Radius.data(), count, visibleBalls.data()) << std::endl;
+    std::cout << "[CullBench] balls batched:   " << TimePerObject(count, iterations, [&]()
+    {
+        return frustum.CullSpheres(balls.PosX.data(), balls.PosY.data(), balls.PosZ.data(), balls.Radius.data(), count, visibleBalls.data());
+    }) << " ns/ball" << std::endl;
+    std::cout << "[CullBench] balls one by one: " << TimePerObject(count, iterations, [&]()
+    {
+        size_t n = 0;
+        for (unsigned int i = 0; i < count; i++)
+            n += singleBalls[i] = frustum.TestSphere(balls.Position(i), balls.Radius[i]) ? 1 : 0;
+        return n;
+    }) << " ns/ball" << std::endl;
+    size_t ballMismatches = 0;
+    for (unsigned int i = 0; i < count; i++)
+        ballMismatches += visibleBalls[i] != singleBalls[i];
+
+    if (!check)
+        return 0;
+
+    // in front of the camera is seen, behind it or past the far plane is not
+    bool planesOk = frustum.TestSphere(Vec3(0.0f, 0.0f, -10.0f), 1.0f) && !frustum.TestSphere(Vec3(0.0f, 0.0f, 10.0f), 1.0f) &&
+                    !frustum.TestSphere(Vec3(0.0f, 0.0f, -200.0f), 1.0f) && frustum.TestSphere(Vec3(0.0f, 0.0f, 0.5f), 1.0f);
+    std::cout << "[CullBench] check: " << boxMismatches << " box and " << ballMismatches << " ball mismatches, planes "
+              << (planesOk ? "ok" : "WRONG") << std::endl;
+    return boxMismatches == 0 && ballMismatches == 0 && planesOk ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "renderer/ImageAllocator.h"
+#include "renderer/MappedFile.h"
+#include "renderer/PngUnfilter.h"
+#include "stb_image.h"
+
+/* Image decoder benchmark over the texture corpus: decodes every file
+   with stock stb_image and with the SIMD PNG unfilter, checks the outputs
+   are byte-identical and reports the median decode time of each. It also
+   decodes each file once more right after a cold one and reports how many
+   of its allocations the image pool served from blocks the first decode
+   freed; --verify requires all of them.
+   Usage: ball_decode_bench [--iterations N] [--verify] [image...]
+   (defaults to everything in res/textures; run from OpenGL/) */
+
+struct DecodeResult
+{
+    std::vector<unsigned char> Pixels;
+    double MedianMs = 0.0;
+    bool Ok = false;
+};
+
+static DecodeResult Decode(const MappedFile& file, int iterations)
+{
+    DecodeResult result;
+    int width, height, channels;
+    if (!stbi_info_from_memory(file.Data(), (int)file.Size(), &width, &height, &channels))
+        return result;
+    // same request the texture loader makes: RGB is expanded to RGBA
+    const int desired = channels == 3 ? 4 : channels;
+
+    std::vector<double> times;
+    for (int i = 0; i < iterations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        unsigned char* data = stbi_load_from_memory(file.Data(), (int)file.Size(), &width, &height, &channels, desired);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        if (!data)
+            return result;
+        if (i == 0)
+            result.Pixels.assign(data, data + (size_t)width * height * desired);
+        stbi_image_free(data);
+    }
+
+    std::sort(times.begin(), times.end());
+    result.MedianMs = times[times.size() / 2];
+    result.Ok = true;
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 10;
+    bool verify = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--verify") == 0)
+            verify = true;
+        else
+            files.push_back(argv[i]);
+    }
+
+    if (files.empty())
+    {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("res/textures", ec))
+        {
+            std::string ext = entry.path().extension().string();
+            if (ext == ".png" || ext == ".jpg" || ext == ".jpeg")
+                files.push_back(entry.path().string());
+        }
+        std::sort(files.begin(), files.end());
+    }
+    if (files.empty())
+    {
+        std::cout << "No images found (run from OpenGL/ or pass paths)" << std::endl;
+        return 1;
+    }
+
+    std::cout << "[DecodeBench] SIMD PNG unfilter " << (PngUnfilterSimdAvailable() ? "available" : "not available on this build") << std::endl;
+
+    int mismatches = 0;
+    for (const std::string& path : files)
+    {
+        MappedFile file;
+        if (!file.Open(path))
+        {
+            std::cout << "Failed to open " << path << std::endl;
+            mismatches++;
+            continue;
+        }
+
+        SetPngUnfilterSimd(false);
+        DecodeResult stock = Decode(file, iterations);
+        SetPngUnfilterSimd(true);
+        DecodeResult simd = Decode(file, iterations);
+
+        bool identical = stock.Ok && simd.Ok && stock.Pixels == simd.Pixels;
+        if (!identical)
+            mismatches++;
+
+        // the same decode twice from an empty pool: the second must not reach the system allocator
+        ImagePoolTrim();
+        Decode(file, 1);
+        ImagePoolStats cold = GetImagePoolStats();
+        Decode(file, 1);
+        ImagePoolStats warm = GetImagePoolStats();
+        size_t allocations = warm.Allocations - cold.Allocations;
+        size_t reused = warm.Reused - cold.Reused;
+        bool recycled = allocations > 0 && reused == allocations;
+        if (!recycled)
+            mismatches++;
+
+        std::cout << "[DecodeBench] " << path << ": stock " << stock.MedianMs << " ms, simd " << simd.MedianMs << " ms ("
+                  << (simd.MedianMs > 0.0 ? stock.MedianMs / simd.MedianMs : 0.0) << "x), "
+                  << (identical ? "identical" : "MISMATCH") << ", pool reused " << reused << "/" << allocations
+                  << " allocations on a second decode" << (recycled ? "" : " MISMATCH") << std::endl;
+    }
+
+    return verify && mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "sim/BallSystem.h"
+#include "sim/ForceField.h"
+#include "sim/UniformGrid.h"
+
+/* Force field benchmark: cost per ball of evaluating growing stacks of
+   fields over N balls. --check verifies that a ball falling with
+   quadratic drag reaches the analytic terminal speed, and that the
+   batched paths agree bit for bit with their scalar counterparts. */
+
+static float Random(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+static double TimeStack(const ForceFieldStack& forces, const BallSystem& balls, unsigned int iterations)
+{
+    std::vector<float> accX(FORCE_BATCH), accY(FORCE_BATCH), accZ(FORCE_BATCH);
+    float sink = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int n = 0; n < iterations; n++)
+    {
+        for (size_t begin = 0; begin < balls.Size(); begin += FORCE_BATCH)
+        {
+            size_t count = std::min(FORCE_BATCH, balls.Size() - begin);
+            forces.Evaluate(balls, begin, count, accX.data(), accY.data(), accZ.data());
+            sink += accX[0];
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 12345.0f)
+        std::cout << sink << std::endl; // keep the work observable
+    return ms * 1.0e6 / ((double)iterations * balls.Size());
+}
+
+static bool CheckTerminalSpeed()
+{
+    const float mass = 1.0f, radius = 0.7f, cd = 0.47f, density = 1.225f, g = 5.0f;
+    ForceFieldStack forces;
+    forces.Air.ScaleHeight = 0.0f;
+    forces.Air.SurfaceDensity = density;
+    forces.Add(std::unique_ptr<ForceField>(new UniformGravity(Vec3(0.0f, -g, 0.0f))));
+    forces.Add(std::unique_ptr<ForceField>(new QuadraticDrag(cd)));
+
+    BallSystem balls;
+    balls.Add(Vec3(0.0f, 1.0e6f, 0.0f), Vec3(), radius, mass);
+    GroundPlane ground;
+    ground.Height = -1.0e30f;
+    UniformGrid grid;
+    std::vector<BallPair> pairs;
+    std::vector<GroundedBall> grounded;
+    for (int i = 0; i < 20000; i++)
+        StepBallSystem(balls, forces, ground, 0.8f, 1.0f / 240.0f, grid, pairs, grounded);
+
+    float expected = std::sqrt(2.0f * mass * g / (density * cd * 3.14159265f * radius * radius));
+    float speed = -balls.VelY[0];
+    bool ok = std::fabs(speed - expected) < 0.005f * expected;
+    std::cout << "[ForceBench] terminal speed: " << speed << " (analytic " << expected << ")" << (ok ? "" : " MISMATCH") << std::endl;
+    return ok;
+}
+
+// whole batches take the vectorized loops, one-ball batches their scalar tails; the results must match bit for bit
+static bool CheckBatchesMatchScalar(const ForceFieldStack& forces, const BallSystem& balls)
+{
+    std::vector<float> accX(FORCE_BATCH), accY(FORCE_BATCH), accZ(FORCE_BATCH);
+    float x, y, z;
+    size_t mismatches = 0;
+    for (size_t begin = 0; begin < balls.Size(); begin += FORCE_BATCH)
+    {
+        size_t count = std::min(FORCE_BATCH, balls.Size() - begin);
+        forces.Evaluate(balls, begin, count, accX.data(), accY.data(), accZ.data());
+        for (size_t i = 0; i < count; i++)
+        {
+            forces.Evaluate(balls, begin + i, 1, &x, &y, &z);
+            if (std::memcmp(&x, &accX[i], sizeof(float)) || std::memcmp(&y, &accY[i], sizeof(float)) || std::memcmp(&z, &accZ[i], sizeof(float)))
+                mismatches++;
+        }
+    }
+    std::cout << "[ForceBench] batched vs scalar: " << (mismatches ? "MISMATCH in " : "identical, ") << (mismatches ? mismatches : balls.Size()) << " balls" << std::endl;
+    return mismatches == 0;
+}
+
+/* StepBallSystem with DefaultForces against StepWithGround, the scalar step the
+   demo balls use, ball by ball. The balls are spread too far apart to touch and
+   the ground is out of reach, so both take the free-flight path; with k formed
+   as the drag field forms it (beta * invMass), every step must match exactly. */
+static bool CheckStepMatchesScalar()
+{
+    const unsigned int count = 1000, steps = 1000;
+    const float dt = 1.0f / 120.0f;
+    PhysicsParams params;
+    params.Beta = 0.3f; // not a power of two, so any change in how k is rounded shows
+    GroundPlane ground;
+    ground.Height = -1.0e30f;
+    ForceFieldStack forces = DefaultForces(params);
+
+    BallSystem balls;
+    std::vector<BallState> reference(count);
+    uint32_t seed = 54321;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        Vec3 position((i % 10) * 1000.0f, ((i / 10) % 10) * 1000.0f, (i / 100) * 1000.0f);
+        Vec3 velocity(Random(seed) * 40.0f - 20.0f, Random(seed) * 40.0f - 20.0f, Random(seed) * 40.0f - 20.0f);
+        balls.Add(position, velocity, 0.7f, 0.5f + Random(seed) * 3.0f);
+        reference[i].Position = position;
+        reference[i].Velocity = velocity;
+    }
+
+    UniformGrid grid;
+    std::vector<BallPair> pairs;
+    std::vector<GroundedBall> grounded;
+    size_t mismatches = 0;
+    unsigned int firstStep = 0;
+    for (unsigned int step = 1; step <= steps; step++)
+    {
+        StepBallSystem(balls, forces, ground, 0.8f, dt, grid, pairs, grounded);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            StepWithGround(reference[i], params.Gravity, params.Beta * balls.InvMass[i], balls.Radius[i], ground, dt);
+            Vec3 p = balls.Position(i), v = balls.Velocity(i);
+            const Vec3 &q = reference[i].Position, &w = reference[i].Velocity;
+            if (std::memcmp(&p, &q, sizeof(Vec3)) || std::memcmp(&v, &w, sizeof(Vec3)))
+            {
+                if (mismatches++ == 0)
+                    firstStep = step;
+            }
+        }
+    }
+    std::cout << "[ForceBench] batched step vs scalar: ";
+    if (mismatches)
+        std::cout << "MISMATCH from step " << firstStep << ", " << mismatches << " ball-steps" << std::endl;
+    else
+        std::cout << "identical, " << count << " balls over " << steps << " steps" << std::endl;
+    return mismatches == 0;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int ballCount = 100000;
+    unsigned int iterations = 50;
+    bool check = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--balls") == 0 && i + 1 < argc)
+            ballCount = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--check") == 0)
+            check = true;
+    }
+
+    if (check && (!CheckTerminalSpeed() || !CheckStepMatchesScalar()))
+        return 1;
+
+    BallSystem balls;
+    balls.Reserve(ballCount);
+    uint32_t seed = 12345;
+    for (unsigned int i = 0; i < ballCount; i++)
+    {
+        Vec3 position(Random(seed) * 200.0f, -50.0f + Random(seed) * 100.0f, Random(seed) * 20.0f);
+        Vec3 velocity(5.0f + Random(seed) * 2.0f - 1.0f, Random(seed) * 2.0f - 1.0f, Random(seed) * 2.0f - 1.0f);
+        Vec3 spin(Random(seed) * 10.0f - 5.0f, Random(seed) * 10.0f - 5.0f, Random(seed) * 10.0f - 5.0f);
+        balls.Add(position, velocity, 0.7f, 1.0f, spin);
+    }
+
+    // a breeze increasing with height
+    auto wind = std::make_shared<WindGrid>(Vec3(0.0f, -50.0f, 0.0f), 10.0f, 21, 11, 3);
+    for (int z = 0; z < 3; z++)
+        for (int y = 0; y < 11; y++)
+            for (int x = 0; x < 21; x++)
+                wind->Set(x, y, z, Vec3(0.3f * y, 0.0f, 0.5f * std::sin(0.3f * x)));
+
+    ForceFieldStack forces = DefaultForces(PhysicsParams());
+    std::cout << "[ForceBench] balls: " << ballCount << std::endl;
+    std::cout << "[ForceBench] gravity + linear drag:   " << TimeStack(forces, balls, iterations) << " ns/ball" << std::endl;
+    forces.Air.ScaleHeight = 8500.0f;
+    forces.Add(std::unique_ptr<ForceField>(new QuadraticDrag()));
+    std::cout << "[ForceBench] + quadratic drag, rho(y): " << TimeStack(forces, balls, iterations) << " ns/ball" << std::endl;
+    forces.Add(std::unique_ptr<ForceField>(new MagnusLift()));
+    std::cout << "[ForceBench] + Magnus lift:           " << TimeStack(forces, balls, iterations) << " ns/ball" << std::endl;
+    forces.Air.Wind = wind;
+    std::cout << "[ForceBench] + wind grid:             " << TimeStack(forces, balls, iterations) << " ns/ball" << std::endl;
+
+    if (check && !CheckBatchesMatchScalar(forces, balls))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "sim/Simulation.h"
+#include "sim/SimulationThread.h"
+#include "sim/StateHash.h"
+
+/* Runs the simulation thread in real time while this thread consumes
+   snapshots like the renderer does, checking each one is consistent. */
+static int RunThreaded(float dt, double seconds)
+{
+    SimulationThread simulation(Vec3D(0.0, 10.0, 0.0), Vec3D(5.0, 0.0, 0.0), dt);
+    simulation.Start();
+
+    unsigned long long snapshots = 0, lastSteps = 0;
+    unsigned int errors = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds)
+    {
+        const SimulationSnapshot& snapshot = simulation.Latest();
+        if (snapshot.Steps == lastSteps)
+            continue;
+        // the newest trajectory point is the published ball position, relative to its chunk origin;
+        // each chunk after the first adds one joint point
+        unsigned int chunks = Trajectory::ChunkCount(snapshot.PathCount);
+        const float* last = snapshot.Path + (size_t)(snapshot.PathCount - 1) * 3;
+        Vec3 expected = Vec3Cast<float>(snapshot.Ball - snapshot.PathOrigins[chunks - 1]);
+        if (snapshot.Steps < lastSteps || snapshot.PathCount > snapshot.Steps + chunks - 1 ||
+            last[0] != expected.x || last[1] != expected.y || last[2] != expected.z)
+            errors++;
+        lastSteps = snapshot.Steps;
+        snapshots++;
+    }
+    simulation.Stop();
+
+    std::cout << "[SimBench] threaded steps:     " << lastSteps << std::endl;
+    std::cout << "[SimBench] snapshots consumed: " << snapshots << std::endl;
+    std::cout << "[SimBench] inconsistent:       " << errors << std::endl;
+    return errors == 0 && snapshots > 0 ? 0 : 1;
+}
+
+/* Steps the demo scene in precision T, hashing every step when hashes is given
+   (only paid for when a log is wanted); returns the elapsed milliseconds. */
+template <typename T>
+static double RunScene(SimulationT<T>& sim, unsigned int steps, T dt, T ground, StateLog* hashes)
+{
+    InitSimulation(sim, Vec3T<T>(0, 10, 0), Vec3T<T>(5, 0, 0));
+    sim.Ground.Height = ground;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < steps; i++)
+    {
+        StepSimulation(sim, dt);
+        if (hashes)
+            hashes->Record(i + 1, HashSimulation(sim));
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename T>
+static void PrintRun(const char* label, const SimulationT<T>& sim, unsigned int steps, double ms)
+{
+    std::cout << "[SimBench] " << label << " steps:      " << steps << std::endl;
+    std::cout << "[SimBench] " << label << " total:      " << ms << " ms" << std::endl;
+    std::cout << "[SimBench] " << label << " steps/sec:  " << (ms > 0.0 ? steps * 1000.0 / ms : 0.0) << std::endl;
+    std::cout.precision(12);
+    std::cout << "[SimBench] " << label << " final position: " << sim.Ball.Position.x << " " << sim.Ball.Position.y << " " << sim.Ball.Position.z << std::endl;
+    std::cout.precision(6);
+    std::cout << "[SimBench] " << label << " final state hash: " << std::hex << HashSimulation(sim) << std::dec << std::endl;
+}
+
+/* Both balls must end the run resting on the ground, centre one radius above
+   it, and further steps must leave them and their trajectories untouched. */
+template <typename T>
+static bool CheckResting(const char* label, SimulationT<T>& sim, T dt)
+{
+    const T contact = sim.Ground.Height + sim.Params.Radius;
+    bool ok = true;
+    const BallStateT<T>* balls[2] = { &sim.Ball, &sim.BallNoFriction };
+    const Trajectory* paths[2] = { &sim.Path, &sim.PathNoFriction };
+    const char* names[2] = { "ball", "no-friction ball" };
+    size_t counts[2] = { sim.Path.Count(), sim.PathNoFriction.Count() };
+    Vec3T<T> positions[2] = { sim.Ball.Position, sim.BallNoFriction.Position };
+    for (int i = 0; i < 2; i++)
+    {
+        if (!balls[i]->Resting || balls[i]->Position.y != contact)
+        {
+            std::cout << "[SimBench] " << label << " " << names[i] << " not resting: y " << balls[i]->Position.y
+                      << " (contact " << contact << "), resting " << balls[i]->Resting << std::endl;
+            ok = false;
+        }
+    }
+
+    for (int i = 0; i < 1000; i++)
+        StepSimulation(sim, dt);
+    for (int i = 0; i < 2; i++)
+    {
+        const Vec3T<T>& p = balls[i]->Position;
+        if (paths[i]->Count() != counts[i] || p.x != positions[i].x || p.y != positions[i].y || p.z != positions[i].z)
+        {
+            std::cout << "[SimBench] " << label << " " << names[i] << " kept moving: path " << counts[i]
+                      << " -> " << paths[i]->Count() << " points" << std::endl;
+            ok = false;
+        }
+    }
+    if (ok)
+        std::cout << "[SimBench] " << label << " resting at y " << contact << ", paths stopped at "
+                  << counts[0] << " and " << counts[1] << " points" << std::endl;
+    return ok;
+}
+
+/* Headless simulation benchmark: steps the demo scene with a fixed
+   timestep and reports throughput, no GL context required. */
+int main(int argc, char** argv)
+{
+    unsigned int steps = 1000000;
+    float dt = 1.0f / 60.0f;
+    double threadedSeconds = 0.0;
+    float ground = GroundPlane().Height;
+    const char* statePath = nullptr;
+    const char* verifyPath = nullptr;
+    const char* precision = "float";
+    bool check = false;
+    double maxDrift = -1.0; // fail when the float run ends further than this from the double run
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+            steps = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--dt") == 0 && i + 1 < argc)
+            dt = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--ground") == 0 && i + 1 < argc)
+            ground = std::strtof(argv[++i], nullptr); // e.g. -1e30 to keep the balls falling
+        else if (std::strcmp(argv[i], "--state-log") == 0 && i + 1 < argc)
+            statePath = argv[++i];
+        else if (std::strcmp(argv[i], "--verify-log") == 0 && i + 1 < argc)
+            verifyPath = argv[++i];
+        else if (std::strcmp(argv[i], "--precision") == 0 && i + 1 < argc)
+            precision = argv[++i]; // float, double or both (reports the float drift)
+        else if (std::strcmp(argv[i], "--threaded") == 0 && i + 1 < argc)
+            threadedSeconds = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--max-drift") == 0 && i + 1 < argc)
+            maxDrift = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--check") == 0)
+            check = true; // the run must end with both balls at rest on the ground
+    }
+
+    if (threadedSeconds > 0.0)
+        return RunThreaded(dt, threadedSeconds);
+
+    bool runFloat = std::strcmp(precision, "double") != 0;
+    bool runDouble = std::strcmp(precision, "float") != 0;
+    if (!runFloat && !runDouble)
+    {
+        std::cout << "Unknown precision " << precision << std::endl;
+        return 1;
+    }
+
+    // the state log follows the float run unless only double was asked for
+    StateLog hashes;
+    StateLog* log = statePath || verifyPath ? &hashes : nullptr;
+    Simulation sim;
+    SimulationD simD;
+    if (runFloat)
+        PrintRun("float", sim, steps, RunScene(sim, steps, dt, ground, log));
+    if (runDouble)
+        PrintRun("double", simD, steps, RunScene(simD, steps, (double)dt, (double)ground, runFloat ? nullptr : log));
+    if (runFloat && runDouble)
+    {
+        double drift = Length(Vec3Cast<double>(sim.Ball.Position) - simD.Ball.Position);
+        std::cout << "[SimBench] float drift from double: " << drift << std::endl;
+        if (maxDrift >= 0.0 && !(drift <= maxDrift))
+        {
+            std::cout << "[SimBench] drift exceeds --max-drift " << maxDrift << std::endl;
+            return 1;
+        }
+    }
+    else if (maxDrift >= 0.0)
+    {
+        std::cout << "--max-drift needs --precision both" << std::endl;
+        return 1;
+    }
+
+    if (check && runFloat && !CheckResting("float", sim, dt))
+        return 1;
+    if (check && runDouble && !CheckResting("double", simD, (double)dt))
+        return 1;
+
+    if (statePath && !hashes.Write(statePath))
+    {
+        std::cout << "Failed to write " << statePath << std::endl;
+        return 1;
+    }
+    if (verifyPath)
+    {
+        StateLog reference;
+        if (!reference.Read(verifyPath))
+        {
+            std::cout << "Failed to read " << verifyPath << std::endl;
+            return 1;
+        }
+        long long mismatch = hashes.FirstMismatch(reference);
+        if (mismatch >= 0)
+        {
+            std::cout << "[SimBench] diverged from " << verifyPath << " at step " << hashes.StepAt((size_t)mismatch) << std::endl;
+            return 1;
+        }
+        if (reference.Size() != hashes.Size())
+        {
+            std::cout << "[SimBench] " << verifyPath << " has " << reference.Size() << " steps, this run " << hashes.Size() << std::endl;
+            return 1;
+        }
+        std::cout << "[SimBench] identical to " << verifyPath << " for all " << hashes.Size() << " steps" << std::endl;
+    }
+    return 0;
+}
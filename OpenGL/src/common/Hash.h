@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// FNV-1a: keys for on-disk cache entries and the simulation state fingerprints; no GL or sim dependency
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline uint64_t HashString(const std::string& text, uint64_t hash = 14695981039346656037ull)
+{
+    // length first, so ("ab", "c") and ("a", "bc") hash differently when chained
+    uint64_t length = text.size();
+    hash = HashBytes(&length, sizeof(length), hash);
+    return HashBytes(text.data(), text.size(), hash);
+}
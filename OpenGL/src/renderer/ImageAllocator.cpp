@@ -0,0 +1,142 @@
+#include "renderer/ImageAllocator.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    // 16-byte header keeps the returned pointer malloc-aligned
+    struct BlockHeader
+    {
+        size_t SizeClass;
+        size_t Capacity;
+    };
+    const size_t HEADER_SIZE = 16;
+    static_assert(sizeof(BlockHeader) <= HEADER_SIZE, "block header too large");
+
+    const size_t MIN_CLASS_SHIFT = 6;   // 64 bytes
+    const size_t MAX_CLASS_SHIFT = 27;  // 128 MB; larger blocks bypass the pool
+    const size_t CLASS_COUNT = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+    const size_t UNPOOLED = (size_t)-1;
+    const size_t MAX_CACHED_BYTES = 256u << 20;
+
+    BlockHeader* HeaderOf(void* block)
+    {
+        return (BlockHeader*)((unsigned char*)block - HEADER_SIZE);
+    }
+
+    struct Pool
+    {
+        std::mutex Mutex;
+        std::vector<void*> FreeLists[CLASS_COUNT];
+        ImagePoolStats Stats;
+
+        ~Pool()
+        {
+            for (std::vector<void*>& list : FreeLists)
+                for (void* block : list)
+                    std::free(HeaderOf(block));
+        }
+    };
+
+    Pool& GetPool()
+    {
+        static Pool pool;
+        return pool;
+    }
+
+    size_t SizeClassFor(size_t size)
+    {
+        size_t shift = MIN_CLASS_SHIFT;
+        while (shift <= MAX_CLASS_SHIFT && ((size_t)1 << shift) < size)
+            shift++;
+        return shift <= MAX_CLASS_SHIFT ? shift - MIN_CLASS_SHIFT : UNPOOLED;
+    }
+}
+
+void* ImagePoolMalloc(size_t size)
+{
+    Pool& pool = GetPool();
+    size_t sizeClass = SizeClassFor(size);
+    {
+        std::lock_guard<std::mutex> lock(pool.Mutex);
+        pool.Stats.Allocations++;
+        if (sizeClass != UNPOOLED && !pool.FreeLists[sizeClass].empty())
+        {
+            void* block = pool.FreeLists[sizeClass].back();
+            pool.FreeLists[sizeClass].pop_back();
+            pool.Stats.Reused++;
+            pool.Stats.CachedBytes -= HeaderOf(block)->Capacity;
+            return block;
+        }
+    }
+
+    size_t capacity = sizeClass != UNPOOLED ? (size_t)1 << (sizeClass + MIN_CLASS_SHIFT) : size;
+    unsigned char* raw = (unsigned char*)std::malloc(HEADER_SIZE + capacity);
+    if (!raw)
+        return nullptr;
+
+    BlockHeader* header = (BlockHeader*)raw;
+    header->SizeClass = sizeClass;
+    header->Capacity = capacity;
+    return raw + HEADER_SIZE;
+}
+
+void* ImagePoolRealloc(void* block, size_t size)
+{
+    if (!block)
+        return ImagePoolMalloc(size);
+
+    BlockHeader* header = HeaderOf(block);
+    if (size <= header->Capacity)
+        return block;
+
+    void* grown = ImagePoolMalloc(size);
+    if (!grown)
+        return nullptr;
+    std::memcpy(grown, block, header->Capacity);
+    ImagePoolFree(block);
+    return grown;
+}
+
+void ImagePoolFree(void* block)
+{
+    if (!block)
+        return;
+
+    BlockHeader* header = HeaderOf(block);
+    if (header->SizeClass != UNPOOLED)
+    {
+        Pool& pool = GetPool();
+        std::lock_guard<std::mutex> lock(pool.Mutex);
+        if (pool.Stats.CachedBytes + header->Capacity <= MAX_CACHED_BYTES)
+        {
+            pool.FreeLists[header->SizeClass].push_back(block);
+            pool.Stats.CachedBytes += header->Capacity;
+            return;
+        }
+    }
+    std::free(header);
+}
+
+void ImagePoolTrim()
+{
+    Pool& pool = GetPool();
+    std::lock_guard<std::mutex> lock(pool.Mutex);
+    for (std::vector<void*>& list : pool.FreeLists)
+    {
+        for (void* block : list)
+            std::free(HeaderOf(block));
+        list.clear();
+    }
+    pool.Stats.CachedBytes = 0;
+}
+
+ImagePoolStats GetImagePoolStats()
+{
+    Pool& pool = GetPool();
+    std::lock_guard<std::mutex> lock(pool.Mutex);
+    return pool.Stats;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+/* Recycling allocator behind stb_image's STBI_MALLOC/STBI_REALLOC/STBI_FREE.
+   Freed blocks are kept in power-of-two size classes and handed back to
+   later decodes, so loading several images does not keep returning
+   multi-megabyte buffers to the system allocator. Thread-safe. */
+
+void* ImagePoolMalloc(size_t size);
+void* ImagePoolRealloc(void* block, size_t size);
+void ImagePoolFree(void* block);
+
+// returns every cached block to the system
+void ImagePoolTrim();
+
+struct ImagePoolStats
+{
+    size_t Allocations = 0;
+    size_t Reused = 0;       // allocations served from a cached block
+    size_t CachedBytes = 0;  // currently held in free lists
+};
+
+ImagePoolStats GetImagePoolStats();
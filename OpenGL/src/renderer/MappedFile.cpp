@@ -0,0 +1,121 @@
+#include "renderer/MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(m_Data, other.m_Data);
+        std::swap(m_Size, other.m_Size);
+#ifdef _WIN32
+        std::swap(m_File, other.m_File);
+        std::swap(m_Mapping, other.m_Mapping);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& filepath)
+{
+    Close();
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_File = file;
+    m_Mapping = mapping;
+    m_Data = (const unsigned char*)view;
+    m_Size = (size_t)size.QuadPart;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+    if (m_Mapping)
+        CloseHandle(m_Mapping);
+    if (m_File)
+        CloseHandle(m_File);
+    m_Data = nullptr;
+    m_Size = 0;
+    m_File = nullptr;
+    m_Mapping = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& filepath)
+{
+    Close();
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file referenced
+    if (view == MAP_FAILED)
+        return false;
+
+    m_Data = (const unsigned char*)view;
+    m_Size = (size_t)st.st_size;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_Data)
+        munmap((void*)m_Data, m_Size);
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/* Read-only memory mapping of a whole file. */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& filepath);
+    void Close();
+
+    const unsigned char* Data() const { return m_Data; }
+    size_t Size() const { return m_Size; }
+    bool IsOpen() const { return m_Data != nullptr; }
+
+private:
+    const unsigned char* m_Data = nullptr;
+    size_t m_Size = 0;
+#ifdef _WIN32
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+#endif
+};
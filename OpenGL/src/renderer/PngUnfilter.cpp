@@ -0,0 +1,224 @@
+#include "renderer/PngUnfilter.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BALL_PNG_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // stb_image's filter ids, including its first-row variants
+    enum PngFilter
+    {
+        FILTER_NONE = 0, FILTER_SUB = 1, FILTER_UP = 2, FILTER_AVG = 3, FILTER_PAETH = 4
+    };
+
+#ifdef BALL_PNG_SSE2
+    std::atomic<bool> s_SimdEnabled(true);
+
+    inline __m128i Load3(const unsigned char* p)
+    {
+        int v = 0;
+        std::memcpy(&v, p, 3);
+        return _mm_cvtsi32_si128(v);
+    }
+
+    inline __m128i Load4(const unsigned char* p)
+    {
+        int v;
+        std::memcpy(&v, p, 4);
+        return _mm_cvtsi32_si128(v);
+    }
+
+    inline void Store3(unsigned char* p, __m128i v)
+    {
+        int x = _mm_cvtsi128_si32(v);
+        std::memcpy(p, &x, 3);
+    }
+
+    inline void Store4(unsigned char* p, __m128i v)
+    {
+        int x = _mm_cvtsi128_si32(v);
+        std::memcpy(p, &x, 4);
+    }
+
+    inline __m128i Abs16(__m128i x)
+    {
+        return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+    }
+
+    inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    // same predictor and tie-breaking (a, then b, then c) as stbi__paeth
+    inline __m128i Paeth(__m128i a, __m128i b, __m128i c)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i a16 = _mm_unpacklo_epi8(a, zero);
+        __m128i b16 = _mm_unpacklo_epi8(b, zero);
+        __m128i c16 = _mm_unpacklo_epi8(c, zero);
+
+        __m128i pa = _mm_sub_epi16(b16, c16);
+        __m128i pb = _mm_sub_epi16(a16, c16);
+        __m128i pc = Abs16(_mm_add_epi16(pa, pb));
+        pa = Abs16(pa);
+        pb = Abs16(pb);
+
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        __m128i nearest = Select(_mm_cmpeq_epi16(smallest, pa), a16,
+                          Select(_mm_cmpeq_epi16(smallest, pb), b16, c16));
+        return _mm_packus_epi16(nearest, nearest);
+    }
+
+    // floor((a + b) / 2) per byte; _mm_avg_epu8 rounds up
+    inline __m128i AvgFloor(__m128i a, __m128i b)
+    {
+        __m128i roundBit = _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1));
+        return _mm_sub_epi8(_mm_avg_epu8(a, b), roundBit);
+    }
+
+    /* One pixel per iteration in the low 3-4 bytes of a register: Sub, Avg
+       and Paeth depend on the pixel to the left, so only the channels of a
+       pixel run in parallel. BPP is the file's bytes per pixel; EXPAND adds
+       an opaque alpha byte (stb's RGB -> RGBA path).
+       3-byte pixels are moved with 4-byte loads/stores: the spare lane is
+       ignored by every filter and a stray store byte is overwritten by the
+       next pixel, so only the last pixel of a row needs exact 3-byte access. */
+    template <int BPP, bool EXPAND, int FILTER, bool LAST>
+    inline __m128i UnfilterPixel(unsigned char* cur, const unsigned char* prior, const unsigned char* raw, __m128i a, __m128i& c)
+    {
+        const int OUT = EXPAND ? BPP + 1 : BPP;
+
+        __m128i x = BPP == 4 || !LAST ? Load4(raw) : Load3(raw);
+        // the prior row is followed by the current row, so reading one byte past a pixel stays in bounds
+        __m128i b = FILTER != FILTER_SUB ? Load4(prior) : _mm_setzero_si128();
+        if (FILTER == FILTER_SUB)
+            x = _mm_add_epi8(x, a);
+        else if (FILTER == FILTER_UP)
+            x = _mm_add_epi8(x, b);
+        else if (FILTER == FILTER_AVG)
+            x = _mm_add_epi8(x, AvgFloor(a, b));
+        else if (FILTER == FILTER_PAETH)
+        {
+            x = _mm_add_epi8(x, Paeth(a, b, c));
+            c = b;
+        }
+
+        if (EXPAND)
+            x = _mm_or_si128(x, _mm_cvtsi32_si128((int)0xFF000000u));
+        if (OUT == 4 || !LAST)
+            Store4(cur, x);
+        else
+            Store3(cur, x);
+        return x;
+    }
+
+    template <int BPP, bool EXPAND, int FILTER>
+    void UnfilterPixels(unsigned char* cur, const unsigned char* prior, const unsigned char* raw, unsigned int pixels)
+    {
+        const int OUT = EXPAND ? BPP + 1 : BPP;
+
+        // a: output pixel to the left, c: prior-row pixel to the left
+        __m128i a = Load4(cur - OUT);
+        __m128i c = FILTER == FILTER_PAETH ? Load4(prior - OUT) : _mm_setzero_si128();
+
+        for (unsigned int i = 0; i + 1 < pixels; i++)
+        {
+            a = UnfilterPixel<BPP, EXPAND, FILTER, false>(cur, prior, raw, a, c);
+            raw += BPP;
+            cur += OUT;
+            prior += OUT;
+        }
+        UnfilterPixel<BPP, EXPAND, FILTER, true>(cur, prior, raw, a, c);
+    }
+
+    template <int BPP, bool EXPAND>
+    void UnfilterPixels(int filter, unsigned char* cur, const unsigned char* prior, const unsigned char* raw, unsigned int pixels)
+    {
+        switch (filter)
+        {
+        case FILTER_SUB:   UnfilterPixels<BPP, EXPAND, FILTER_SUB>(cur, prior, raw, pixels); break;
+        case FILTER_UP:    UnfilterPixels<BPP, EXPAND, FILTER_UP>(cur, prior, raw, pixels); break;
+        case FILTER_AVG:   UnfilterPixels<BPP, EXPAND, FILTER_AVG>(cur, prior, raw, pixels); break;
+        case FILTER_PAETH: UnfilterPixels<BPP, EXPAND, FILTER_PAETH>(cur, prior, raw, pixels); break;
+        }
+    }
+
+    // Up has no left dependency, so rows with matching layouts go 16 bytes at a time
+    void UnfilterUpWide(unsigned char* cur, const unsigned char* prior, const unsigned char* raw, size_t bytes)
+    {
+        size_t k = 0;
+        for (; k + 16 <= bytes; k += 16)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(raw + k));
+            __m128i b = _mm_loadu_si128((const __m128i*)(prior + k));
+            _mm_storeu_si128((__m128i*)(cur + k), _mm_add_epi8(x, b));
+        }
+        for (; k < bytes; k++)
+            cur[k] = (unsigned char)(raw[k] + prior[k]);
+    }
+#endif
+}
+
+int PngUnfilterRow(int filter, unsigned char* cur, const unsigned char* prior, const unsigned char* raw,
+                   unsigned int pixels, int filterBytes, int outputBytes)
+{
+#ifdef BALL_PNG_SSE2
+    if (!s_SimdEnabled.load(std::memory_order_relaxed) || filter > FILTER_PAETH || pixels == 0)
+        return 0;
+
+    const bool expand = outputBytes == filterBytes + 1;
+    if (filter == FILTER_UP && !expand)
+    {
+        UnfilterUpWide(cur, prior, raw, (size_t)pixels * filterBytes);
+        return 1;
+    }
+    if (filter == FILTER_NONE)
+        return 0; // stb already turns this into a memcpy / simple copy
+
+    if (filterBytes == 4 && !expand)
+        UnfilterPixels<4, false>(filter, cur, prior, raw, pixels);
+    else if (filterBytes == 3 && !expand)
+        UnfilterPixels<3, false>(filter, cur, prior, raw, pixels);
+    else if (filterBytes == 3 && expand)
+        UnfilterPixels<3, true>(filter, cur, prior, raw, pixels);
+    else
+        return 0; // grey and grey+alpha rows stay on stb's loops
+    return 1;
+#else
+    (void)filter; (void)cur; (void)prior; (void)raw; (void)pixels; (void)filterBytes; (void)outputBytes;
+    return 0;
+#endif
+}
+
+bool PngUnfilterSimdAvailable()
+{
+#ifdef BALL_PNG_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SetPngUnfilterSimd(bool enabled)
+{
+#ifdef BALL_PNG_SSE2
+    s_SimdEnabled.store(enabled, std::memory_order_relaxed);
+#else
+    (void)enabled;
+#endif
+}
+
+bool PngUnfilterSimdEnabled()
+{
+#ifdef BALL_PNG_SSE2
+    return s_SimdEnabled.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
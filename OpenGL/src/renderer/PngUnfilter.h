@@ -0,0 +1,15 @@
+#pragma once
+
+/* SSE2 PNG row unfiltering plugged into stb_image through its
+   STBI_PNG_UNFILTER_ROW hook (see stb_image.cpp). Output is
+   byte-identical to stb's scalar loops; toggle it at runtime to compare. */
+
+// called by stb_image for 8-bit rows after the first pixel; returns 0 to use stb's own loop
+int PngUnfilterRow(int filter, unsigned char* cur, const unsigned char* prior, const unsigned char* raw,
+                   unsigned int pixels, int filterBytes, int outputBytes);
+
+// false when the build has no SIMD kernels for this CPU
+bool PngUnfilterSimdAvailable();
+// on by default when available; process-wide
+void SetPngUnfilterSimd(bool enabled);
+bool PngUnfilterSimdEnabled();
@@ -0,0 +1,313 @@
+#include "renderer/Shader.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string_view>
+#ifdef _MSC_VER
+#include <malloc.h>
+#else
+#include <alloca.h>
+#endif
+
+#include "renderer/ShaderCache.h"
+
+namespace
+{
+    enum class ShaderType
+    {
+        NONE = -1, VERTEX = 0, FRAGMENT = 1, GEOMETRY = 2, COMPUTE = 3
+    };
+
+    struct CachedFile
+    {
+        std::filesystem::file_time_type Stamp;
+        std::shared_ptr<const std::string> Text;
+    };
+
+    // include snippets shared by many programs are read once and reused until they change on disk
+    std::mutex s_FileCacheMutex;
+    std::map<std::string, CachedFile> s_FileCache;
+
+    // SetShaderDefine values; ParseShader also runs on the hot-reload thread
+    std::mutex s_DefinesMutex;
+    std::map<std::string, std::string> s_Defines;
+
+    std::shared_ptr<const std::string> ReadShaderFile(const std::string& path)
+    {
+        std::error_code ec;
+        auto stamp = std::filesystem::last_write_time(path, ec);
+        {
+            std::lock_guard<std::mutex> lock(s_FileCacheMutex);
+            auto it = s_FileCache.find(path);
+            if (it != s_FileCache.end() && !ec && it->second.Stamp == stamp)
+                return it->second.Text;
+        }
+
+        // one read of the whole file
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+            return nullptr;
+        auto text = std::make_shared<std::string>();
+        stream.seekg(0, std::ios::end);
+        text->resize((size_t)stream.tellg());
+        stream.seekg(0, std::ios::beg);
+        stream.read(&(*text)[0], (std::streamsize)text->size());
+
+        std::lock_guard<std::mutex> lock(s_FileCacheMutex);
+        s_FileCache[path] = { stamp, text };
+        return text;
+    }
+
+    std::string_view TrimLeft(std::string_view s)
+    {
+        size_t i = 0;
+        while (i < s.size() && (s[i] == ' ' || s[i] == '\t'))
+            i++;
+        return s.substr(i);
+    }
+
+    bool StartsWith(std::string_view s, std::string_view prefix)
+    {
+        return s.substr(0, prefix.size()) == prefix;
+    }
+
+    // "#define" lines go right after "#version", which must stay the first statement
+    void InjectDefines(std::string& stage, const std::string& defines)
+    {
+        if (stage.empty() || defines.empty())
+            return;
+        size_t at = 0;
+        size_t version = stage.find("#version");
+        if (version != std::string::npos)
+        {
+            size_t end = stage.find('\n', version);
+            at = end == std::string::npos ? stage.size() : end + 1;
+        }
+        stage.insert(at, defines);
+    }
+
+    struct ParseState
+    {
+        ShaderType Type = ShaderType::NONE;
+        std::string* Stages[4];
+        std::set<std::string> Included[4]; // include guard per stage
+        std::vector<std::string>* Dependencies;
+        std::vector<std::string>* FeedbackVaryings;
+    };
+
+    void ParseFile(const std::string& path, ParseState& state, bool topLevel)
+    {
+        std::shared_ptr<const std::string> text = ReadShaderFile(path);
+        if (!text)
+        {
+            std::cout << "Failed to open shader file " << path << std::endl;
+            return;
+        }
+        if (std::find(state.Dependencies->begin(), state.Dependencies->end(), path) == state.Dependencies->end())
+            state.Dependencies->push_back(path);
+
+        std::string_view rest(*text);
+        while (!rest.empty())
+        {
+            size_t end = rest.find('\n');
+            std::string_view line = rest.substr(0, end);
+            rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 1);
+            std::string_view directive = TrimLeft(line);
+
+            if (topLevel && StartsWith(directive, "#shader"))
+            {
+                std::string_view stage = TrimLeft(directive.substr(7));
+                if (StartsWith(stage, "vertex"))
+                    state.Type = ShaderType::VERTEX;
+                else if (StartsWith(stage, "fragment"))
+                    state.Type = ShaderType::FRAGMENT;
+                else if (StartsWith(stage, "geometry"))
+                    state.Type = ShaderType::GEOMETRY;
+                else if (StartsWith(stage, "compute"))
+                    state.Type = ShaderType::COMPUTE;
+                else
+                    std::cout << "Unknown shader stage in " << path << ": " << stage << std::endl;
+                continue;
+            }
+
+            // text before the first marker belongs to no stage
+            if (state.Type == ShaderType::NONE)
+                continue;
+            int stage = (int)state.Type;
+
+            if (StartsWith(directive, "#feedback"))
+            {
+                std::string_view names = directive.substr(9);
+                for (size_t begin = names.find_first_not_of(" \t\r"); begin != std::string_view::npos; begin = names.find_first_not_of(" \t\r"))
+                {
+                    names = names.substr(begin);
+                    size_t end = names.find_first_of(" \t\r");
+                    state.FeedbackVaryings->emplace_back(names.substr(0, end));
+                    names = end == std::string_view::npos ? std::string_view() : names.substr(end);
+                }
+                continue;
+            }
+
+            if (StartsWith(directive, "#include"))
+            {
+                std::string_view name = TrimLeft(directive.substr(8));
+                size_t open = name.find('"');
+                size_t close = open == std::string_view::npos ? open : name.find('"', open + 1);
+                if (close == std::string_view::npos)
+                {
+                    std::cout << "Malformed #include in " << path << std::endl;
+                    continue;
+                }
+                std::filesystem::path included = std::filesystem::path(path).parent_path() / std::string(name.substr(open + 1, close - open - 1));
+                std::string includedPath = included.lexically_normal().generic_string();
+                if (state.Included[stage].insert(includedPath).second)
+                    ParseFile(includedPath, state, false);
+                continue;
+            }
+
+            std::string& out = *state.Stages[stage];
+            out.append(line.data(), line.size());
+            out += '\n';
+        }
+    }
+}
+
+ShaderProgramSource ParseShader(const std::string& filepath)
+{
+    ShaderProgramSource source;
+    ParseState state;
+    state.Stages[(int)ShaderType::VERTEX] = &source.VertexSource;
+    state.Stages[(int)ShaderType::FRAGMENT] = &source.FragmentSource;
+    state.Stages[(int)ShaderType::GEOMETRY] = &source.GeometrySource;
+    state.Stages[(int)ShaderType::COMPUTE] = &source.ComputeSource;
+    state.Dependencies = &source.Dependencies;
+    state.FeedbackVaryings = &source.FeedbackVaryings;
+    ParseFile(filepath, state, true);
+
+    std::string defines;
+    {
+        std::lock_guard<std::mutex> lock(s_DefinesMutex);
+        for (const auto& define : s_Defines)
+            defines += "#define " + define.first + " " + define.second + "\n";
+    }
+    InjectDefines(source.VertexSource, defines);
+    InjectDefines(source.FragmentSource, defines);
+    InjectDefines(source.GeometrySource, defines);
+    InjectDefines(source.ComputeSource, defines);
+    return source;
+}
+
+void SetShaderDefine(const std::string& name, const std::string& value)
+{
+    std::lock_guard<std::mutex> lock(s_DefinesMutex);
+    s_Defines[name] = value;
+}
+
+unsigned int CompileShader(unsigned int type, const std::string& source)
+{
+    unsigned int id = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(id, 1, &src, nullptr);
+    glCompileShader(id);
+
+    int result;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+    if (result == GL_FALSE)
+    {
+        int length;
+        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+        char* message = (char*)alloca(length * sizeof(char));
+        glGetShaderInfoLog(id, length, &length, message);
+        std::cout << "Failed to compile shader!" << std::endl;
+        std::cout << message << std::endl;
+        glDeleteShader(id);
+        return 0;
+    }
+
+    return id;
+}
+
+unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+{
+    ShaderProgramSource source;
+    source.VertexSource = vertexShader;
+    source.FragmentSource = fragmentShader;
+    return CreateShader(source);
+}
+
+unsigned int CreateShader(const ShaderProgramSource& source)
+{
+    const std::pair<unsigned int, const std::string*> stages[] = {
+        { GL_VERTEX_SHADER, &source.VertexSource },
+        { GL_GEOMETRY_SHADER, &source.GeometrySource },
+        { GL_FRAGMENT_SHADER, &source.FragmentSource },
+        { GL_COMPUTE_SHADER, &source.ComputeSource },
+    };
+
+    unsigned int program = glCreateProgram();
+    std::vector<unsigned int> shaders;
+    bool compiled = true;
+    for (const auto& stage : stages)
+    {
+        if (stage.second->empty())
+            continue;
+        unsigned int id = CompileShader(stage.first, *stage.second);
+        if (!id)
+        {
+            compiled = false;
+            break;
+        }
+        glAttachShader(program, id);
+        shaders.push_back(id);
+    }
+
+    int linked = GL_FALSE;
+    if (compiled)
+    {
+        if (ProgramBinarySupported())
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        SetFeedbackVaryings(program, source);
+        glLinkProgram(program);
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == GL_FALSE)
+        {
+            int length = 0;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+            std::string message(length > 0 ? length : 1, '\0');
+            glGetProgramInfoLog(program, (int)message.size(), &length, &message[0]);
+            std::cout << "Failed to link program!" << std::endl;
+            std::cout << message.c_str() << std::endl;
+        }
+    }
+
+    for (unsigned int id : shaders)
+    {
+        glDetachShader(program, id);
+        glDeleteShader(id);
+    }
+
+    if (linked == GL_FALSE)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void SetFeedbackVaryings(unsigned int program, const ShaderProgramSource& source)
+{
+    if (source.FeedbackVaryings.empty())
+        return;
+    std::vector<const char*> names;
+    for (const std::string& name : source.FeedbackVaryings)
+        names.push_back(name.c_str());
+    glTransformFeedbackVaryings(program, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
+}
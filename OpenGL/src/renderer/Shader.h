@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct ShaderProgramSource
+{
+    std::string VertexSource;
+    std::string FragmentSource;
+    std::string GeometrySource; // optional
+    std::string ComputeSource;  // a compute program has only this stage
+    std::vector<std::string> FeedbackVaryings; // outputs captured by transform feedback, interleaved in this order
+    std::vector<std::string> Dependencies; // the file itself plus every #include it pulled in
+};
+
+/* Splits a .shader file into stages at "#shader vertex|fragment|geometry|compute"
+   markers. '#include "file"' lines are replaced by that file (path relative
+   to the including file); each file is included at most once per stage.
+   "#feedback name..." lines list transform feedback varyings. */
+ShaderProgramSource ParseShader(const std::string& filepath);
+/* Adds "#define name value" after the #version line of every stage parsed
+   from now on, so shaders take sizes from the C++ constants they must
+   agree with instead of copies of them. Part of the parsed source, so
+   cached program binaries follow a changed value. */
+void SetShaderDefine(const std::string& name, const std::string& value);
+unsigned int CompileShader(unsigned int type, const std::string& source);
+unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+// compiles and links every stage present; returns 0 (after printing the logs) on failure
+unsigned int CreateShader(const ShaderProgramSource& source);
+// declares source.FeedbackVaryings on program; must precede glLinkProgram
+void SetFeedbackVaryings(unsigned int program, const ShaderProgramSource& source);
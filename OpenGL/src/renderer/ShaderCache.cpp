@@ -0,0 +1,126 @@
+#include "renderer/ShaderCache.h"
+
+#include <GL/glew.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "common/Hash.h"
+#include "renderer/Shader.h"
+
+namespace
+{
+    const char PROGRAM_MAGIC[4] = { 'B', 'P', 'R', 'G' };
+    const uint32_t PROGRAM_VERSION = 1;
+
+    struct ProgramHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t Key;
+        uint32_t BinaryFormat;
+        uint32_t Length;
+    };
+
+    std::string ProgramPath(const std::string& cacheDir, uint64_t key)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.prg", (unsigned long long)key);
+        return cacheDir + "/" + name;
+    }
+
+    std::string GLString(GLenum name)
+    {
+        const char* value = (const char*)glGetString(name);
+        return value ? value : "";
+    }
+}
+
+bool ProgramBinarySupported()
+{
+    if (!GLEW_ARB_get_program_binary)
+        return false;
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+uint64_t ProgramCacheKey(const ShaderProgramSource& source)
+{
+    uint64_t key = HashString(source.VertexSource);
+    key = HashString(source.FragmentSource, key);
+    key = HashString(source.GeometrySource, key);
+    key = HashString(source.ComputeSource, key);
+    for (const std::string& name : source.FeedbackVaryings)
+        key = HashString(name, key);
+    key = HashString(GLString(GL_VENDOR), key);
+    key = HashString(GLString(GL_RENDERER), key);
+    key = HashString(GLString(GL_VERSION), key);
+    return key;
+}
+
+unsigned int LoadProgramBinary(const std::string& cacheDir, uint64_t key)
+{
+    std::ifstream in(ProgramPath(cacheDir, key), std::ios::binary);
+    if (!in)
+        return 0;
+    std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (file.size() < sizeof(ProgramHeader))
+        return 0;
+
+    ProgramHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.Magic, PROGRAM_MAGIC, 4) != 0 || header.Version != PROGRAM_VERSION
+        || header.Key != key || header.Length != file.size() - sizeof(header))
+        return 0;
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, header.BinaryFormat, file.data() + sizeof(header), (int)header.Length);
+
+    // the driver may refuse binaries from another build of itself
+    int linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+bool StoreProgramBinary(const std::string& cacheDir, uint64_t key, unsigned int program)
+{
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return false;
+
+    std::vector<char> binary(length);
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+
+    ProgramHeader header;
+    std::memcpy(header.Magic, PROGRAM_MAGIC, 4);
+    header.Version = PROGRAM_VERSION;
+    header.Key = key;
+    header.BinaryFormat = binaryFormat;
+    header.Length = (uint32_t)length;
+
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDir, ec);
+    std::string path = ProgramPath(cacheDir, key);
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary);
+        out.write((const char*)&header, sizeof(header));
+        out.write(binary.data(), length);
+        if (!out)
+            return false;
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct ShaderProgramSource;
+
+/* On-disk cache of linked programs via glGetProgramBinary. Entries are
+   keyed by the shader sources plus the driver's vendor/renderer/version
+   strings, so a driver update or a shader edit simply misses the cache. */
+
+// needs GL 4.1 / ARB_get_program_binary and at least one binary format
+bool ProgramBinarySupported();
+uint64_t ProgramCacheKey(const ShaderProgramSource& source);
+
+// creates a program from a cached binary; 0 on a miss or when the driver rejects the binary
+unsigned int LoadProgramBinary(const std::string& cacheDir, uint64_t key);
+bool StoreProgramBinary(const std::string& cacheDir, uint64_t key, unsigned int program);
@@ -0,0 +1,135 @@
+#include "renderer/ShaderQueue.h"
+
+#include <GL/glew.h>
+
+#include <iostream>
+
+#include "renderer/Shader.h"
+#include "renderer/ShaderCache.h"
+
+static unsigned int SubmitShader(unsigned int type, const std::string& source)
+{
+    unsigned int id = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(id, 1, &src, nullptr);
+    glCompileShader(id);
+    return id;
+}
+
+static void PrintShaderLog(unsigned int id, const std::string& path)
+{
+    int result;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+    if (result == GL_TRUE)
+        return;
+
+    int length = 0;
+    glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+    std::string message(length > 0 ? length : 1, '\0');
+    glGetShaderInfoLog(id, (int)message.size(), &length, &message[0]);
+    std::cout << "Failed to compile shader! (" << path << ")" << std::endl;
+    std::cout << message.c_str() << std::endl;
+}
+
+ShaderBuildQueue::ShaderBuildQueue(const std::string& cacheDir)
+    : m_CacheDir(cacheDir)
+{
+    m_BinaryCache = ProgramBinarySupported();
+    m_ParallelCompile = GLEW_KHR_parallel_shader_compile != 0;
+    if (m_ParallelCompile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu); // let the driver pick
+}
+
+unsigned int ShaderBuildQueue::Submit(const std::string& filepath)
+{
+    ShaderProgramSource source = ParseShader(filepath);
+    uint64_t key = 0;
+    if (m_BinaryCache)
+    {
+        key = ProgramCacheKey(source);
+        if (unsigned int program = LoadProgramBinary(m_CacheDir, key))
+            return program;
+    }
+
+    PendingProgram pending;
+    pending.Path = filepath;
+    pending.CacheKey = key;
+    pending.Program = glCreateProgram();
+    const std::pair<unsigned int, const std::string*> stages[] = {
+        { GL_VERTEX_SHADER, &source.VertexSource },
+        { GL_GEOMETRY_SHADER, &source.GeometrySource },
+        { GL_FRAGMENT_SHADER, &source.FragmentSource },
+        { GL_COMPUTE_SHADER, &source.ComputeSource },
+    };
+    for (const auto& stage : stages)
+    {
+        if (stage.second->empty())
+            continue;
+        unsigned int id = SubmitShader(stage.first, *stage.second);
+        glAttachShader(pending.Program, id);
+        pending.Shaders.push_back(id);
+    }
+    if (m_BinaryCache)
+        glProgramParameteri(pending.Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    SetFeedbackVaryings(pending.Program, source);
+    glLinkProgram(pending.Program);
+
+    m_Pending.push_back(pending);
+    return pending.Program;
+}
+
+bool ShaderBuildQueue::IsPending(unsigned int program) const
+{
+    for (const PendingProgram& pending : m_Pending)
+        if (pending.Program == program)
+            return true;
+    return false;
+}
+
+bool ShaderBuildQueue::IsReady(unsigned int program) const
+{
+    if (!m_ParallelCompile)
+        return true; // without the extension any query blocks anyway
+    int done = GL_TRUE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+bool ShaderBuildQueue::Finish(unsigned int program)
+{
+    for (size_t i = 0; i < m_Pending.size(); i++)
+    {
+        if (m_Pending[i].Program != program)
+            continue;
+
+        PendingProgram pending = m_Pending[i];
+        m_Pending.erase(m_Pending.begin() + i);
+
+        int linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == GL_FALSE)
+        {
+            for (unsigned int id : pending.Shaders)
+                PrintShaderLog(id, pending.Path);
+            int length = 0;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+            std::string message(length > 0 ? length : 1, '\0');
+            glGetProgramInfoLog(program, (int)message.size(), &length, &message[0]);
+            std::cout << "Failed to link program! (" << pending.Path << ")" << std::endl;
+            std::cout << message.c_str() << std::endl;
+        }
+
+        for (unsigned int id : pending.Shaders)
+        {
+            glDetachShader(program, id);
+            glDeleteShader(id);
+        }
+
+        if (linked == GL_TRUE && m_BinaryCache)
+            StoreProgramBinary(m_CacheDir, pending.CacheKey, program);
+        return linked == GL_TRUE;
+    }
+
+    // loaded from the binary cache, or already finished
+    return true;
+}
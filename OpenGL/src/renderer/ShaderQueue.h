@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Builds several shader programs concurrently. Submit() issues every
+   compile and the link without querying any status, so the driver can
+   work on all programs at once (in parallel threads with
+   KHR_parallel_shader_compile). Status is only checked in Finish(),
+   right before a program is first used: poll IsReady() each frame and
+   finish a program once it reports complete. Cached program binaries
+   (ShaderCache.h) are used when available. */
+class ShaderBuildQueue
+{
+public:
+    explicit ShaderBuildQueue(const std::string& cacheDir = "res/cache");
+
+    // returns the program name immediately; it is usable after Finish()
+    unsigned int Submit(const std::string& filepath);
+
+    // true until Finish() has run for a program from Submit(); programs from the binary cache never are
+    bool IsPending(unsigned int program) const;
+    // non-blocking: true once the driver has finished compiling and linking
+    bool IsReady(unsigned int program) const;
+    // waits for the program, reports compile/link errors and stores its binary; false on failure,
+    // in which case the caller still owns the program and should delete it
+    bool Finish(unsigned int program);
+
+private:
+    struct PendingProgram
+    {
+        std::string Path;
+        unsigned int Program;
+        std::vector<unsigned int> Shaders;
+        uint64_t CacheKey;
+    };
+
+    std::string m_CacheDir;
+    bool m_BinaryCache;
+    bool m_ParallelCompile;
+    std::vector<PendingProgram> m_Pending;
+};
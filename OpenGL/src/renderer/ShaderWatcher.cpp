@@ -0,0 +1,204 @@
+#include "renderer/ShaderWatcher.h"
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+ShaderWatcher::ShaderWatcher()
+    : m_Stopping(false)
+{
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    m_Stopping = true;
+    if (m_Thread.joinable())
+        m_Thread.join();
+}
+
+void ShaderWatcher::Watch(const std::string& filepath, unsigned int* program)
+{
+    for (WatchedFile& file : m_Files)
+    {
+        if (file.Path == filepath)
+        {
+            file.Programs.push_back(program);
+            return;
+        }
+    }
+    m_Files.push_back({ filepath, { program }, ParseShader(filepath).Dependencies });
+}
+
+void ShaderWatcher::Start()
+{
+    if (!m_Thread.joinable() && !m_Files.empty())
+        m_Thread = std::thread(&ShaderWatcher::ThreadLoop, this);
+}
+
+void ShaderWatcher::Reparse(const std::string& filepath)
+{
+    ShaderProgramSource source = ParseShader(filepath);
+    for (WatchedFile& file : m_Files)
+        if (file.Path == filepath)
+            file.Dependencies = source.Dependencies; // an edit may add or drop includes
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Reparsed[filepath] = std::move(source);
+}
+
+#ifdef __linux__
+
+void ShaderWatcher::ThreadLoop()
+{
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cout << "Shader hot reload unavailable (inotify)" << std::endl;
+        return;
+    }
+
+    // watch directories rather than files: editors often save by renaming a temp file over the original
+    std::map<int, std::string> directories;
+    auto watchDependencies = [&]()
+    {
+        for (const WatchedFile& file : m_Files)
+        {
+            for (const std::string& dependency : file.Dependencies)
+            {
+                std::string dir = std::filesystem::path(dependency).parent_path().string();
+                if (dir.empty())
+                    dir = ".";
+                // adding the same directory again returns the existing descriptor
+                int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+                if (wd >= 0)
+                    directories[wd] = dir;
+            }
+        }
+    };
+    watchDependencies();
+
+    alignas(inotify_event) char buffer[4096];
+    while (!m_Stopping)
+    {
+        pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+
+        std::set<std::string> changed;
+        ssize_t length;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* p = buffer; p < buffer + length; )
+            {
+                const inotify_event* event = (const inotify_event*)p;
+                if (event->len > 0 && directories.count(event->wd))
+                {
+                    std::filesystem::path path = std::filesystem::path(directories[event->wd]) / event->name;
+                    for (const WatchedFile& file : m_Files)
+                        for (const std::string& dependency : file.Dependencies)
+                            if (std::filesystem::path(dependency).lexically_normal() == path.lexically_normal())
+                                changed.insert(file.Path);
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        // one save can produce several events; reparse each file once
+        for (const std::string& path : changed)
+            Reparse(path);
+        if (!changed.empty())
+            watchDependencies();
+    }
+
+    close(fd);
+}
+
+#else
+
+void ShaderWatcher::ThreadLoop()
+{
+    std::map<std::string, std::filesystem::file_time_type> stamps;
+    std::error_code ec;
+    for (const WatchedFile& file : m_Files)
+        for (const std::string& dependency : file.Dependencies)
+            stamps[dependency] = std::filesystem::last_write_time(dependency, ec);
+
+    while (!m_Stopping)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        std::set<std::string> changed;
+        for (auto& entry : stamps)
+        {
+            auto stamp = std::filesystem::last_write_time(entry.first, ec);
+            if (!ec && stamp != entry.second)
+            {
+                entry.second = stamp;
+                for (const WatchedFile& file : m_Files)
+                    for (const std::string& dependency : file.Dependencies)
+                        if (dependency == entry.first)
+                            changed.insert(file.Path);
+            }
+        }
+        for (const std::string& path : changed)
+        {
+            Reparse(path);
+            for (const WatchedFile& file : m_Files)
+                for (const std::string& dependency : file.Dependencies)
+                    if (!stamps.count(dependency))
+                        stamps[dependency] = std::filesystem::last_write_time(dependency, ec);
+        }
+    }
+}
+
+#endif
+
+bool ShaderWatcher::Update()
+{
+    std::map<std::string, ShaderProgramSource> reparsed;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Reparsed.empty())
+            return false;
+        reparsed.swap(m_Reparsed);
+    }
+
+    bool replaced = false;
+    for (auto& entry : reparsed)
+    {
+        const std::string& path = entry.first;
+        const ShaderProgramSource& source = entry.second;
+
+        unsigned int program = CreateShader(source);
+        if (!program)
+        {
+            std::cout << "Shader reload failed, keeping the old program (" << path << ")" << std::endl;
+            continue;
+        }
+
+        for (WatchedFile& file : m_Files)
+        {
+            if (file.Path != path)
+                continue;
+            // every slot for this file shares the new program; delete each old one once
+            std::set<unsigned int> old;
+            for (unsigned int* slot : file.Programs)
+            {
+                old.insert(*slot);
+                *slot = program;
+            }
+            for (unsigned int id : old)
+                glDeleteProgram(id);
+        }
+        std::cout << "Reloaded shader " << path << std::endl;
+        replaced = true;
+    }
+    return replaced;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "renderer/Shader.h"
+
+/* Hot reload for .shader files. A background thread waits for edits
+   (inotify on Linux, modification-time polling elsewhere) and reparses
+   changed files (and every file that #includes them); Update() then rebuilds them on the GL thread and swaps
+   the program only if it compiled and linked, so a typo keeps the old
+   shader running instead of tearing down the scene. */
+class ShaderWatcher
+{
+public:
+    ShaderWatcher();
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // program is updated in place when filepath changes; register before Start()
+    void Watch(const std::string& filepath, unsigned int* program);
+    void Start();
+
+    // call between frames on the GL thread; returns true if any program was replaced
+    bool Update();
+
+private:
+    struct WatchedFile
+    {
+        std::string Path;
+        std::vector<unsigned int*> Programs;
+        std::vector<std::string> Dependencies; // owned by the watcher thread once started
+    };
+
+    void ThreadLoop();
+    void Reparse(const std::string& filepath);
+
+    std::vector<WatchedFile> m_Files;
+    std::thread m_Thread;
+    std::atomic<bool> m_Stopping;
+
+    std::mutex m_Mutex;
+    std::map<std::string, ShaderProgramSource> m_Reparsed; // latest parse per file, consumed by Update()
+};
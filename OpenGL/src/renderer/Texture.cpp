@@ -0,0 +1,112 @@
+#include "renderer/Texture.h"
+
+#include <GL/glew.h>
+
+#include <cstring>
+
+#include "renderer/TextureCompression.h"
+#include "renderer/TextureImage.h"
+
+// images at least this large are streamed through a pixel buffer object
+static const size_t PBO_UPLOAD_THRESHOLD = 256 * 1024;
+
+static void ChooseFormats(int channels, GLenum& internalFormat, GLenum& format)
+{
+    switch (channels)
+    {
+    case 1:  internalFormat = GL_R8;    format = GL_RED;  break;
+    case 2:  internalFormat = GL_RG8;   format = GL_RG;   break;
+    case 3:  internalFormat = GL_RGB8;  format = GL_RGB;  break;
+    default: internalFormat = GL_RGBA8; format = GL_RGBA; break;
+    }
+}
+
+// largest alignment GL_UNPACK_ALIGNMENT accepts that divides the row size
+static int RowAlignment(size_t rowBytes)
+{
+    if (rowBytes % 8 == 0) return 8;
+    if (rowBytes % 4 == 0) return 4;
+    if (rowBytes % 2 == 0) return 2;
+    return 1;
+}
+
+unsigned int CreateTexture(const TextureImage& image)
+{
+    // transparent fallback: expand BC1 on the CPU when the driver cannot sample it
+    if (image.Format == TextureFormat::BC1 && !GLEW_EXT_texture_compression_s3tc)
+    {
+        TextureImage decoded;
+        DecompressBC1(image, decoded);
+        return CreateTexture(decoded);
+    }
+
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)image.Levels.size() - 1);
+
+    GLenum internalFormat, format;
+    ChooseFormats(image.Channels, internalFormat, format);
+    if (image.Format == TextureFormat::RAW && image.Channels <= 2)
+    {
+        // grey and grey+alpha images sample as (L, L, L, A)
+        GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, image.Channels == 2 ? GL_GREEN : GL_ONE };
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+
+    /* Large images go through a PBO: one copy into driver memory, then the
+       glTexImage2D calls source from the buffer and return without waiting
+       for the transfer. Small ones are cheaper to upload directly. */
+    const MipLevel& last = image.Levels.back();
+    const size_t totalSize = last.Offset + last.Size;
+    const unsigned char* source = image.Base();
+    unsigned int pbo = 0;
+    if (totalSize >= PBO_UPLOAD_THRESHOLD)
+    {
+        glGenBuffers(1, &pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped)
+        {
+            std::memcpy(mapped, source, totalSize);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            source = nullptr; // level data is now addressed by offset into the PBO
+        }
+        else
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glDeleteBuffers(1, &pbo);
+            pbo = 0;
+        }
+    }
+
+    for (size_t level = 0; level < image.Levels.size(); level++)
+    {
+        const MipLevel& mip = image.Levels[level];
+        const void* pixels = (const unsigned char*)source + mip.Offset;
+        if (image.Format == TextureFormat::BC1)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, (int)level, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, mip.Width, mip.Height, 0, (int)mip.Size, pixels);
+        }
+        else
+        {
+            // mip rows are tightly packed, so odd widths need a smaller alignment
+            glPixelStorei(GL_UNPACK_ALIGNMENT, RowAlignment((size_t)mip.Width * image.Channels));
+            glTexImage2D(GL_TEXTURE_2D, (int)level, internalFormat, mip.Width, mip.Height, 0, format, GL_UNSIGNED_BYTE, pixels);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (pbo)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &pbo); // the driver keeps it alive until the transfer completes
+    }
+
+    return texture;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+struct TextureImage;
+
+// creates a GL_TEXTURE_2D from a decoded image and its mip chain; must run on the GL thread
+unsigned int CreateTexture(const TextureImage& image);
@@ -0,0 +1,166 @@
+#include "renderer/TextureCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "renderer/MappedFile.h"
+#include "renderer/TextureImage.h"
+
+namespace
+{
+    const char CACHE_MAGIC[4] = { 'B', 'T', 'E', 'X' };
+    // bump whenever the pixel layout stored in the cache changes
+    const uint32_t CACHE_VERSION = 3;
+    // larger than any GL_MAX_TEXTURE_SIZE, keeps the level size arithmetic far from overflow
+    const uint32_t MAX_DIMENSION = 1u << 16;
+
+    struct CacheHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t SourceHash;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t Channels;
+        uint32_t LevelCount;
+        uint32_t Format; // TextureFormat
+        uint32_t Origin; // TextureOrigin
+    };
+
+    struct CacheLevel
+    {
+        uint32_t Width;
+        uint32_t Height;
+        uint64_t Offset; // from the start of the pixel data
+        uint64_t Size;
+    };
+}
+
+bool HashSourceFile(const std::string& filepath, uint64_t& hash)
+{
+    MappedFile file;
+    if (!file.Open(filepath))
+        return false;
+
+    hash = HashBytes(file.Data(), file.Size());
+    return true;
+}
+
+std::string CachePath(const std::string& cacheDir, uint64_t sourceHash)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.tex", (unsigned long long)sourceHash);
+    return cacheDir + "/" + name;
+}
+
+bool ReadTextureCache(const std::string& cacheDir, uint64_t sourceHash, TextureImage& image)
+{
+    return ReadTextureFile(CachePath(cacheDir, sourceHash), sourceHash, image);
+}
+
+bool WriteTextureCache(const std::string& cacheDir, uint64_t sourceHash, const TextureImage& image)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDir, ec);
+    return WriteTextureFile(CachePath(cacheDir, sourceHash), sourceHash, image);
+}
+
+bool ReadTextureFile(const std::string& filepath, uint64_t sourceHash, TextureImage& image)
+{
+    MappedFile file;
+    if (!file.Open(filepath) || file.Size() < sizeof(CacheHeader))
+        return false;
+
+    CacheHeader header;
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (std::memcmp(header.Magic, CACHE_MAGIC, 4) != 0 || header.Version != CACHE_VERSION
+        || header.SourceHash != sourceHash || header.LevelCount == 0 || header.Format > (uint32_t)TextureFormat::BC1
+        || header.Origin > (uint32_t)TextureOrigin::TOP_LEFT || header.Channels < 1 || header.Channels > 4)
+        return false;
+    const TextureFormat format = (TextureFormat)header.Format;
+
+    size_t pixelsOffset = sizeof(CacheHeader) + header.LevelCount * sizeof(CacheLevel);
+    if (file.Size() < pixelsOffset)
+        return false;
+
+    std::vector<MipLevel> levels(header.LevelCount);
+    for (uint32_t i = 0; i < header.LevelCount; i++)
+    {
+        CacheLevel level;
+        std::memcpy(&level, file.Data() + sizeof(CacheHeader) + i * sizeof(CacheLevel), sizeof(level));
+        size_t available = file.Size() - pixelsOffset;
+        if (level.Offset > available || level.Size > available - level.Offset)
+            return false;
+        // the uploader and the BC1 decoder trust Size to cover the whole level
+        if (level.Width == 0 || level.Height == 0 || level.Width > MAX_DIMENSION || level.Height > MAX_DIMENSION
+            || level.Size != LevelSize(format, (int)header.Channels, (int)level.Width, (int)level.Height))
+            return false;
+        levels[i].Width = (int)level.Width;
+        levels[i].Height = (int)level.Height;
+        levels[i].Offset = (size_t)level.Offset;
+        levels[i].Size = (size_t)level.Size;
+    }
+
+    image.Width = (int)header.Width;
+    image.Height = (int)header.Height;
+    image.Channels = (int)header.Channels;
+    image.FileChannels = 0;
+    image.Format = format;
+    image.Origin = (TextureOrigin)header.Origin;
+    image.Levels = std::move(levels);
+    image.Storage.Clear();
+    image.Mapping = std::move(file);
+    image.MappingOffset = pixelsOffset;
+    return true;
+}
+
+bool WriteTextureFile(const std::string& path, uint64_t sourceHash, const TextureImage& image)
+{
+    std::error_code ec;
+
+    // write to a private temp name and rename, so readers never see a partial entry
+    std::string tempPath = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream out(tempPath, std::ios::binary);
+        if (!out)
+            return false;
+
+        CacheHeader header;
+        std::memcpy(header.Magic, CACHE_MAGIC, 4);
+        header.Version = CACHE_VERSION;
+        header.SourceHash = sourceHash;
+        header.Width = (uint32_t)image.Width;
+        header.Height = (uint32_t)image.Height;
+        header.Channels = (uint32_t)image.Channels;
+        header.LevelCount = (uint32_t)image.Levels.size();
+        header.Format = (uint32_t)image.Format;
+        header.Origin = (uint32_t)image.Origin;
+        out.write((const char*)&header, sizeof(header));
+
+        for (const MipLevel& mip : image.Levels)
+        {
+            CacheLevel level = { (uint32_t)mip.Width, (uint32_t)mip.Height, (uint64_t)mip.Offset, (uint64_t)mip.Size };
+            out.write((const char*)&level, sizeof(level));
+        }
+
+        const MipLevel& last = image.Levels.back();
+        out.write((const char*)image.Base(), last.Offset + last.Size);
+        if (!out)
+        {
+            out.close();
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
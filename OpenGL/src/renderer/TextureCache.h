@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "common/Hash.h"
+
+struct TextureImage;
+
+/* Binary cache of decoded textures with all mip levels. Entries are
+   named after a hash of the source file, so edited sources miss the
+   cache and old entries are simply never read again. */
+
+// FNV-1a over the file contents; returns false if the file cannot be read
+bool HashSourceFile(const std::string& filepath, uint64_t& hash);
+std::string CachePath(const std::string& cacheDir, uint64_t sourceHash);
+
+// maps a cache entry into image; false on miss or a stale/corrupt entry
+bool ReadTextureCache(const std::string& cacheDir, uint64_t sourceHash, TextureImage& image);
+bool WriteTextureCache(const std::string& cacheDir, uint64_t sourceHash, const TextureImage& image);
+
+// same container at an explicit path, used for offline-compressed textures
+bool ReadTextureFile(const std::string& filepath, uint64_t sourceHash, TextureImage& image);
+bool WriteTextureFile(const std::string& filepath, uint64_t sourceHash, const TextureImage& image);
@@ -0,0 +1,259 @@
+#include "renderer/TextureCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "renderer/TextureImage.h"
+
+namespace
+{
+    const size_t BC1_BLOCK_SIZE = 8;
+
+    uint16_t PackRGB565(const float* c)
+    {
+        int r = (int)std::lround(std::clamp(c[0], 0.0f, 255.0f) * 31.0f / 255.0f);
+        int g = (int)std::lround(std::clamp(c[1], 0.0f, 255.0f) * 63.0f / 255.0f);
+        int b = (int)std::lround(std::clamp(c[2], 0.0f, 255.0f) * 31.0f / 255.0f);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    void UnpackRGB565(uint16_t c, int* rgb)
+    {
+        int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    // the four-colour palette for c0 > c1 (two endpoints plus 1/3 and 2/3 blends)
+    void BuildPalette(uint16_t c0, uint16_t c1, int palette[4][3])
+    {
+        UnpackRGB565(c0, palette[0]);
+        UnpackRGB565(c1, palette[1]);
+        for (int i = 0; i < 3; i++)
+        {
+            if (c0 > c1)
+            {
+                palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+                palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+            }
+            else
+            {
+                palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+                palette[3][i] = 0;
+            }
+        }
+    }
+
+    /* Range fit along the principal axis of the block's colours: endpoints
+       are the extreme projections, each texel takes the nearest palette entry. */
+    void EncodeBlock(const unsigned char block[16][3], unsigned char* out)
+    {
+        float mean[3] = { 0.0f, 0.0f, 0.0f };
+        for (int p = 0; p < 16; p++)
+            for (int i = 0; i < 3; i++)
+                mean[i] += block[p][i] / 16.0f;
+
+        float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int p = 0; p < 16; p++)
+        {
+            float d[3] = { block[p][0] - mean[0], block[p][1] - mean[1], block[p][2] - mean[2] };
+            cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+            cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+        }
+
+        // power iteration for the dominant eigenvector
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iter = 0; iter < 8; iter++)
+        {
+            float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+            float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+            float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+            float len = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+            if (len < 1e-6f)
+                break;
+            axis[0] = x / len; axis[1] = y / len; axis[2] = z / len;
+        }
+
+        float minProj = 1e30f, maxProj = -1e30f;
+        for (int p = 0; p < 16; p++)
+        {
+            float proj = (block[p][0] - mean[0]) * axis[0] + (block[p][1] - mean[1]) * axis[1] + (block[p][2] - mean[2]) * axis[2];
+            minProj = std::min(minProj, proj);
+            maxProj = std::max(maxProj, proj);
+        }
+        float norm = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+        if (norm < 1e-12f)
+            norm = 1.0f;
+        float hi[3], lo[3];
+        for (int i = 0; i < 3; i++)
+        {
+            hi[i] = mean[i] + axis[i] * maxProj / norm;
+            lo[i] = mean[i] + axis[i] * minProj / norm;
+        }
+
+        uint16_t c0 = PackRGB565(hi);
+        uint16_t c1 = PackRGB565(lo);
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        uint32_t indices = 0;
+        if (c0 != c1)
+        {
+            int palette[4][3];
+            BuildPalette(c0, c1, palette);
+            for (int p = 0; p < 16; p++)
+            {
+                int best = 0, bestDist = 1 << 30;
+                for (int e = 0; e < 4; e++)
+                {
+                    int dr = block[p][0] - palette[e][0];
+                    int dg = block[p][1] - palette[e][1];
+                    int db = block[p][2] - palette[e][2];
+                    int dist = dr * dr + dg * dg + db * db;
+                    if (dist < bestDist)
+                    {
+                        bestDist = dist;
+                        best = e;
+                    }
+                }
+                indices |= (uint32_t)best << (2 * p);
+            }
+        }
+
+        out[0] = (unsigned char)(c0 & 0xFF);
+        out[1] = (unsigned char)(c0 >> 8);
+        out[2] = (unsigned char)(c1 & 0xFF);
+        out[3] = (unsigned char)(c1 >> 8);
+        for (int i = 0; i < 4; i++)
+            out[4 + i] = (unsigned char)(indices >> (8 * i));
+    }
+}
+
+bool CompressBC1(const TextureImage& source, TextureImage& compressed)
+{
+    if (source.Format != TextureFormat::RAW || source.Channels < 3 || source.Levels.empty())
+        return false;
+
+    const int channels = source.Channels;
+    size_t total = 0;
+    for (const MipLevel& level : source.Levels)
+        total += LevelSize(TextureFormat::BC1, 3, level.Width, level.Height);
+
+    compressed.Width = source.Width;
+    compressed.Height = source.Height;
+    compressed.Channels = 3;
+    compressed.FileChannels = source.FileChannels;
+    compressed.Format = TextureFormat::BC1;
+    compressed.Origin = source.Origin;
+    compressed.Mapping.Close();
+    compressed.Storage.Clear();
+    if (!compressed.Storage.Resize(total))
+        return false;
+    compressed.Levels.clear();
+
+    size_t offset = 0;
+    for (size_t l = 0; l < source.Levels.size(); l++)
+    {
+        const MipLevel& src = source.Levels[l];
+        const unsigned char* pixels = source.LevelData(l);
+
+        MipLevel dst;
+        dst.Width = src.Width;
+        dst.Height = src.Height;
+        dst.Offset = offset;
+        dst.Size = LevelSize(TextureFormat::BC1, 3, src.Width, src.Height);
+
+        unsigned char* out = compressed.Storage.Data() + offset;
+        for (int by = 0; by < src.Height; by += 4)
+        {
+            for (int bx = 0; bx < src.Width; bx += 4)
+            {
+                // partial edge blocks repeat the last row/column
+                unsigned char block[16][3];
+                for (int y = 0; y < 4; y++)
+                {
+                    for (int x = 0; x < 4; x++)
+                    {
+                        int sx = std::min(bx + x, src.Width - 1);
+                        int sy = std::min(by + y, src.Height - 1);
+                        std::memcpy(block[y * 4 + x], pixels + ((size_t)sy * src.Width + sx) * channels, 3);
+                    }
+                }
+                EncodeBlock(block, out);
+                out += BC1_BLOCK_SIZE;
+            }
+        }
+
+        compressed.Levels.push_back(dst);
+        offset += dst.Size;
+    }
+    return true;
+}
+
+bool DecompressBC1(const TextureImage& compressed, TextureImage& decoded)
+{
+    if (compressed.Format != TextureFormat::BC1 || compressed.Levels.empty())
+        return false;
+
+    size_t total = 0;
+    for (const MipLevel& level : compressed.Levels)
+        total += (size_t)level.Width * level.Height * 3;
+
+    decoded.Width = compressed.Width;
+    decoded.Height = compressed.Height;
+    decoded.Channels = 3;
+    decoded.FileChannels = compressed.FileChannels;
+    decoded.Format = TextureFormat::RAW;
+    decoded.Origin = compressed.Origin;
+    decoded.Mapping.Close();
+    decoded.Storage.Clear();
+    if (!decoded.Storage.Resize(total))
+        return false;
+    decoded.Levels.clear();
+
+    size_t offset = 0;
+    for (size_t l = 0; l < compressed.Levels.size(); l++)
+    {
+        const MipLevel& src = compressed.Levels[l];
+        const unsigned char* in = compressed.LevelData(l);
+
+        MipLevel dst;
+        dst.Width = src.Width;
+        dst.Height = src.Height;
+        dst.Offset = offset;
+        dst.Size = (size_t)src.Width * src.Height * 3;
+
+        unsigned char* pixels = decoded.Storage.Data() + offset;
+        for (int by = 0; by < src.Height; by += 4)
+        {
+            for (int bx = 0; bx < src.Width; bx += 4)
+            {
+                uint16_t c0 = (uint16_t)(in[0] | (in[1] << 8));
+                uint16_t c1 = (uint16_t)(in[2] | (in[3] << 8));
+                uint32_t indices = (uint32_t)in[4] | ((uint32_t)in[5] << 8) | ((uint32_t)in[6] << 16) | ((uint32_t)in[7] << 24);
+                int palette[4][3];
+                BuildPalette(c0, c1, palette);
+
+                for (int y = 0; y < 4 && by + y < src.Height; y++)
+                {
+                    for (int x = 0; x < 4 && bx + x < src.Width; x++)
+                    {
+                        const int* c = palette[(indices >> (2 * (y * 4 + x))) & 3];
+                        unsigned char* p = pixels + ((size_t)(by + y) * src.Width + bx + x) * 3;
+                        p[0] = (unsigned char)c[0];
+                        p[1] = (unsigned char)c[1];
+                        p[2] = (unsigned char)c[2];
+                    }
+                }
+                in += BC1_BLOCK_SIZE;
+            }
+        }
+
+        decoded.Levels.push_back(dst);
+        offset += dst.Size;
+    }
+    return true;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+struct TextureImage;
+
+// encodes every level of a RAW image (3 or 4 channels, alpha dropped) to BC1
+bool CompressBC1(const TextureImage& source, TextureImage& compressed);
+// expands a BC1 image back to RAW RGB, the fallback when the driver lacks S3TC
+bool DecompressBC1(const TextureImage& compressed, TextureImage& decoded);
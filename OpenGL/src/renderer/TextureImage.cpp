@@ -0,0 +1,189 @@
+#include "renderer/TextureImage.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "renderer/ImageAllocator.h"
+#include "renderer/TextureCache.h"
+#include "stb_image.h"
+
+PixelBuffer::~PixelBuffer()
+{
+    Clear();
+}
+
+PixelBuffer::PixelBuffer(PixelBuffer&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+PixelBuffer& PixelBuffer::operator=(PixelBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Clear();
+        m_Data = other.m_Data;
+        m_Size = other.m_Size;
+        other.m_Data = nullptr;
+        other.m_Size = 0;
+    }
+    return *this;
+}
+
+void PixelBuffer::Adopt(unsigned char* data, size_t size)
+{
+    Clear();
+    m_Data = data;
+    m_Size = size;
+}
+
+bool PixelBuffer::Resize(size_t size)
+{
+    unsigned char* data = (unsigned char*)ImagePoolRealloc(m_Data, size);
+    if (!data)
+        return false;
+    m_Data = data;
+    m_Size = size;
+    return true;
+}
+
+void PixelBuffer::Clear()
+{
+    ImagePoolFree(m_Data);
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+bool BuildMipChain(TextureImage& image)
+{
+    const int channels = image.Channels;
+    int width = image.Levels.back().Width;
+    int height = image.Levels.back().Height;
+
+    while (width > 1 || height > 1)
+    {
+        const MipLevel src = image.Levels.back();
+        MipLevel dst;
+        dst.Width = std::max(width / 2, 1);
+        dst.Height = std::max(height / 2, 1);
+        dst.Offset = src.Offset + src.Size;
+        dst.Size = (size_t)dst.Width * dst.Height * channels;
+        if (!image.Storage.Resize(dst.Offset + dst.Size))
+            return false;
+
+        // 2x2 box filter; odd edges reuse the last row/column
+        const unsigned char* in = image.Storage.Data() + src.Offset;
+        unsigned char* out = image.Storage.Data() + dst.Offset;
+        for (int y = 0; y < dst.Height; y++)
+        {
+            const unsigned char* row0 = in + (size_t)std::min(2 * y, src.Height - 1) * src.Width * channels;
+            const unsigned char* row1 = in + (size_t)std::min(2 * y + 1, src.Height - 1) * src.Width * channels;
+            for (int x = 0; x < dst.Width; x++)
+            {
+                int x0 = std::min(2 * x, src.Width - 1) * channels;
+                int x1 = std::min(2 * x + 1, src.Width - 1) * channels;
+                for (int c = 0; c < channels; c++)
+                {
+                    int sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                    *out++ = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+
+        image.Levels.push_back(dst);
+        width = dst.Width;
+        height = dst.Height;
+    }
+    return true;
+}
+
+size_t LevelSize(TextureFormat format, int channels, int width, int height)
+{
+    if (format == TextureFormat::BC1)
+        return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * 8; // 8 bytes per 4x4 block
+    return (size_t)width * height * channels;
+}
+
+std::string CompressedTexturePath(const std::string& filepath)
+{
+    return filepath + ".bc1";
+}
+
+bool DecodeImageFromMemory(const unsigned char* bytes, size_t size, TextureImage& image)
+{
+    // preflight from the header so the whole mip chain is sized before decoding
+    int width, height, channels;
+    if (!stbi_info_from_memory(bytes, (int)size, &width, &height, &channels))
+        return false;
+
+    // RGB is padded to RGBA during decode, on the worker, so uploads hit the
+    // drivers' native 4-byte texel layout instead of a GL-thread conversion
+    const int desiredChannels = channels == 3 ? 4 : channels;
+    channels = desiredChannels;
+
+    size_t chainSize = 0;
+    for (int w = width, h = height; ; w = std::max(w / 2, 1), h = std::max(h / 2, 1))
+    {
+        chainSize += (size_t)w * h * channels;
+        if (w == 1 && h == 1)
+            break;
+    }
+
+    int fileChannels;
+    unsigned char* data = stbi_load_from_memory(bytes, (int)size, &width, &height, &fileChannels, desiredChannels);
+    if (!data)
+        return false;
+
+    MipLevel base;
+    base.Width = width;
+    base.Height = height;
+    base.Size = (size_t)width * height * channels;
+
+    image.Width = width;
+    image.Height = height;
+    image.Channels = channels;
+    image.FileChannels = fileChannels;
+    image.Format = TextureFormat::RAW;
+    image.Origin = TextureOrigin::TOP_LEFT; // rows stay in file order, no flip pass
+    image.Mapping.Close();
+    // the decoded buffer becomes the base level; growing it to the chain size
+    // stays in place whenever the pool block already has room
+    image.Storage.Adopt(data, base.Size);
+    if (!image.Storage.Resize(chainSize))
+        return false;
+    image.Levels.assign(1, base);
+
+    return BuildMipChain(image);
+}
+
+bool DecodeImage(const std::string& filepath, TextureImage& image)
+{
+    MappedFile file;
+    if (!file.Open(filepath))
+        return false;
+    return DecodeImageFromMemory(file.Data(), file.Size(), image);
+}
+
+bool LoadTextureImage(const std::string& filepath, const std::string& cacheDir, TextureImage& image)
+{
+    // one mapping of the source serves both the hash and the decode
+    MappedFile source;
+    if (!source.Open(filepath))
+        return false;
+    uint64_t hash = HashBytes(source.Data(), source.Size());
+
+    // written offline by ball_texcompress; stale if the source changed since
+    if (ReadTextureFile(CompressedTexturePath(filepath), hash, image))
+        return true;
+
+    bool cacheable = !cacheDir.empty();
+    if (cacheable && ReadTextureCache(cacheDir, hash, image))
+        return true;
+
+    if (!DecodeImageFromMemory(source.Data(), source.Size(), image))
+        return false;
+
+    if (cacheable)
+        WriteTextureCache(cacheDir, hash, image);
+    return true;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "renderer/MappedFile.h"
+
+enum class TextureFormat
+{
+    RAW = 0, // 8-bit channels, tightly packed rows
+    BC1 = 1  // S3TC DXT1, 8 bytes per 4x4 block, opaque RGB
+};
+
+// row order of the pixel data; stb_image decodes top row first
+enum class TextureOrigin
+{
+    BOTTOM_LEFT = 0, // GL convention, v = 0 is the first row
+    TOP_LEFT = 1     // sample with v flipped, see texFlipY in BasicSphere.shader
+};
+
+/* Pixel storage from the image pool, so a buffer decoded by stb_image
+   can be adopted as-is and grown in place for the mip chain. */
+class PixelBuffer
+{
+public:
+    PixelBuffer() = default;
+    ~PixelBuffer();
+
+    PixelBuffer(PixelBuffer&& other) noexcept;
+    PixelBuffer& operator=(PixelBuffer&& other) noexcept;
+    PixelBuffer(const PixelBuffer&) = delete;
+    PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+    // takes ownership of a block from ImagePoolMalloc / stbi_load
+    void Adopt(unsigned char* data, size_t size);
+    // grows or shrinks keeping the contents; new bytes are uninitialized
+    bool Resize(size_t size);
+    void Clear();
+
+    unsigned char* Data() { return m_Data; }
+    const unsigned char* Data() const { return m_Data; }
+    size_t Size() const { return m_Size; }
+
+private:
+    unsigned char* m_Data = nullptr;
+    size_t m_Size = 0;
+};
+
+struct MipLevel
+{
+    int Width = 0;
+    int Height = 0;
+    size_t Offset = 0; // from TextureImage::Base()
+    size_t Size = 0;
+};
+
+/* A decoded texture with its full mip chain, ready for upload.
+   Pixels live either in Storage (fresh decode) or in a mapped cache file. */
+struct TextureImage
+{
+    int Width = 0;
+    int Height = 0;
+    int Channels = 0;
+    int FileChannels = 0; // channels in the source file before RGB is padded to RGBA; 0 when not decoded from a file
+    TextureFormat Format = TextureFormat::RAW;
+    TextureOrigin Origin = TextureOrigin::TOP_LEFT;
+    std::vector<MipLevel> Levels;
+    PixelBuffer Storage;
+    MappedFile Mapping;
+    size_t MappingOffset = 0;
+
+    const unsigned char* Base() const { return Mapping.IsOpen() ? Mapping.Data() + MappingOffset : Storage.Data(); }
+    const unsigned char* LevelData(size_t level) const { return Base() + Levels[level].Offset; }
+};
+
+// bytes one mip level of the given size takes in the given format
+size_t LevelSize(TextureFormat format, int channels, int width, int height);
+
+// appends box-filtered mip levels down to 1x1 after the base level already in image.Storage;
+// false if the storage cannot grow, with the levels built so far kept
+bool BuildMipChain(TextureImage& image);
+
+// decodes an in-memory image file and builds its mip chain, no caching
+bool DecodeImageFromMemory(const unsigned char* bytes, size_t size, TextureImage& image);
+// same for a file on disk, read through a memory mapping
+bool DecodeImage(const std::string& filepath, TextureImage& image);
+// where the offline compressor stores the BC1 version of a source image
+std::string CompressedTexturePath(const std::string& filepath);
+
+/* Produces a texture with mips for an image file. An up-to-date
+   offline-compressed "<filepath>.bc1" next to the source wins, then the
+   on-disk cache in cacheDir (empty disables caching), then a fresh
+   decode. GL-free, safe to call from worker threads. */
+bool LoadTextureImage(const std::string& filepath, const std::string& cacheDir, TextureImage& image);
@@ -0,0 +1,149 @@
+#include "renderer/TextureLoader.h"
+
+#include <iostream>
+
+#include "renderer/Texture.h"
+
+TextureLoader::TextureLoader(const std::string& cacheDir, unsigned int threadCount)
+    : m_CacheDir(cacheDir)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (unsigned int i = 0; i < threadCount; i++)
+        m_Workers.emplace_back(&TextureLoader::WorkerLoop, this);
+}
+
+TextureLoader::~TextureLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_QueueChanged.notify_all();
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+unsigned int TextureLoader::Request(const std::string& filepath)
+{
+    unsigned int handle;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        handle = (unsigned int)m_Jobs.size();
+        m_Jobs.emplace_back();
+        m_Jobs.back().Path = filepath;
+        m_Queue.push_back(handle);
+    }
+    m_QueueChanged.notify_one();
+    return handle;
+}
+
+void TextureLoader::WorkerLoop()
+{
+    for (;;)
+    {
+        std::string path;
+        unsigned int handle;
+        TextureImage image;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_QueueChanged.wait(lock, [this] { return m_Stopping || !m_Queue.empty(); });
+            if (m_Queue.empty())
+                return;
+            handle = m_Queue.front();
+            m_Queue.pop_front();
+            path = m_Jobs[handle].Path;
+        }
+
+        bool loaded = LoadTextureImage(path, m_CacheDir, image);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            Job& job = m_Jobs[handle];
+            job.Image = std::move(image);
+            job.Loaded = loaded;
+            job.Decoded = true;
+        }
+        m_JobDecoded.notify_all();
+    }
+}
+
+bool TextureLoader::UploadReady()
+{
+    struct ReadyJob
+    {
+        unsigned int Handle;
+        bool Loaded;
+        std::string Path;
+        TextureImage Image;
+    };
+
+    // take the decoded images under the lock and upload without it: Request()
+    // may grow m_Jobs meanwhile, and GL calls should not stall the workers
+    std::vector<ReadyJob> ready;
+    bool allUploaded = true;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (size_t handle = 0; handle < m_Jobs.size(); handle++)
+        {
+            Job& job = m_Jobs[handle];
+            if (job.Uploaded || job.Uploading)
+                continue;
+            if (!job.Decoded)
+            {
+                allUploaded = false;
+                continue;
+            }
+            job.Uploading = true;
+            ready.push_back({ (unsigned int)handle, job.Loaded, job.Path, std::move(job.Image) });
+        }
+    }
+
+    for (ReadyJob& upload : ready)
+    {
+        unsigned int texture = 0;
+        if (upload.Loaded)
+            texture = CreateTexture(upload.Image);
+        else
+            std::cout << "Failed to load texture " << upload.Path << std::endl;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        Job& job = m_Jobs[upload.Handle];
+        job.Texture = texture;
+        if (upload.Loaded)
+            job.Origin = upload.Image.Origin;
+        job.Uploading = false;
+        job.Uploaded = true;
+    }
+    return allUploaded;
+}
+
+void TextureLoader::WaitAndUpload()
+{
+    // upload in completion order so GL work overlaps with decodes still running
+    while (!UploadReady())
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_JobDecoded.wait(lock, [this] {
+            for (const Job& job : m_Jobs)
+                if (job.Decoded && !job.Uploaded)
+                    return true;
+            return false;
+        });
+    }
+}
+
+unsigned int TextureLoader::Texture(unsigned int handle) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return handle < m_Jobs.size() ? m_Jobs[handle].Texture : 0;
+}
+
+TextureOrigin TextureLoader::Origin(unsigned int handle) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return handle < m_Jobs.size() ? m_Jobs[handle].Origin : TextureOrigin::BOTTOM_LEFT;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "renderer/TextureImage.h"
+
+/* Decodes images on a worker pool and uploads them on the GL thread.
+   Request() every texture up front, then call WaitAndUpload() (or poll
+   UploadReady() between frames) from the thread owning the GL context. */
+class TextureLoader
+{
+public:
+    // threadCount 0 picks std::thread::hardware_concurrency(); empty cacheDir disables the texture cache
+    explicit TextureLoader(const std::string& cacheDir = "res/cache", unsigned int threadCount = 0);
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // queues a decode and returns a handle for Texture()
+    unsigned int Request(const std::string& filepath);
+
+    // uploads every decoded image without blocking; returns true once all requests are uploaded
+    bool UploadReady();
+    // blocks until every request is decoded, then uploads the rest
+    void WaitAndUpload();
+
+    // GL texture name for a handle, 0 until uploaded or if decoding failed
+    unsigned int Texture(unsigned int handle) const;
+    // row order of the uploaded pixels, for the shader's texFlipY
+    TextureOrigin Origin(unsigned int handle) const;
+
+private:
+    struct Job
+    {
+        std::string Path;
+        TextureImage Image;
+        bool Loaded = false; // Image holds a valid texture
+        bool Decoded = false;
+        bool Uploading = false; // image taken by UploadReady(), GL upload in progress
+        bool Uploaded = false;
+        unsigned int Texture = 0;
+        TextureOrigin Origin = TextureOrigin::BOTTOM_LEFT;
+    };
+
+    void WorkerLoop();
+
+    std::string m_CacheDir;
+    std::vector<std::thread> m_Workers;
+    std::deque<Job> m_Jobs; // deque keeps references stable while workers fill them
+    std::deque<unsigned int> m_Queue;
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_QueueChanged;
+    std::condition_variable m_JobDecoded;
+    bool m_Stopping = false;
+};
@@ -0,0 +1,123 @@
+#include "renderer/TrajectoryBuffer.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+
+static const size_t CHUNK_BYTES = (size_t)Trajectory::CHUNK_POINTS * 3 * sizeof(float);
+
+TrajectoryChunkPool::TrajectoryChunkPool(unsigned int slots)
+    : m_Slots(slots), m_VAO(0), m_VBO(0)
+{
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(CHUNK_BYTES * slots), nullptr, GL_DYNAMIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)0);
+    glBindVertexArray(0);
+}
+
+TrajectoryChunkPool::~TrajectoryChunkPool()
+{
+    DeleteBuffers();
+}
+
+void TrajectoryChunkPool::DeleteBuffers()
+{
+    if (m_VBO)
+        glDeleteBuffers(1, &m_VBO);
+    if (m_VAO)
+        glDeleteVertexArrays(1, &m_VAO);
+    m_VBO = m_VAO = 0;
+}
+
+void TrajectoryChunkPool::Upload(const std::vector<ChunkSlotTable::Upload>& uploads, const float* points)
+{
+    if (uploads.empty())
+        return;
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    for (const ChunkSlotTable::Upload& upload : uploads)
+    {
+        size_t firstInChunk = upload.From % Trajectory::CHUNK_POINTS;
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(CHUNK_BYTES * upload.Slot + firstInChunk * 3 * sizeof(float)),
+                        (GLsizeiptr)(upload.To - upload.From) * 3 * sizeof(float), points + (size_t)upload.From * 3);
+    }
+}
+
+TrajectoryBuffer::TrajectoryBuffer(TrajectoryChunkPool& pool)
+    : m_Pool(pool), m_Table(pool.m_Slots), m_Points(nullptr)
+{
+}
+
+void TrajectoryBuffer::Append(const float* points, unsigned int count)
+{
+    if (count <= m_Table.Count())
+        return;
+    m_Points = points;
+    ExtendChunkBounds(m_Bounds, points, m_Table.Count(), count, Trajectory::CHUNK_POINTS);
+
+    // a chunk left without a slot is uploaded when it is next drawn
+    m_Uploads.clear();
+    m_Table.Append(count, m_Uploads);
+    m_Pool.Upload(m_Uploads, m_Points);
+}
+
+unsigned int TrajectoryBuffer::Draw(const Vec3D* origins, const Vec3D& eye, const Frustum& frustum, int slotOffsetsLocation)
+{
+    const unsigned int chunks = m_Table.Chunks();
+    if (chunks == 0)
+        return 0;
+
+    // chunk boxes in the camera-relative space the shader draws in, as SoA for the batched test
+    m_Boxes.resize((size_t)chunks * 6);
+    m_Visible.resize(chunks);
+    float* centerX = m_Boxes.data();
+    float* centerY = centerX + chunks;
+    float* centerZ = centerY + chunks;
+    float* extentX = centerZ + chunks;
+    float* extentY = extentX + chunks;
+    float* extentZ = extentY + chunks;
+    for (unsigned int c = 0; c < chunks; c++)
+    {
+        Vec3 offset = Vec3Cast<float>(origins[c] - eye);
+        const Aabb& box = m_Bounds[c];
+        centerX[c] = 0.5f * (box.Min.x + box.Max.x) + offset.x;
+        centerY[c] = 0.5f * (box.Min.y + box.Max.y) + offset.y;
+        centerZ[c] = 0.5f * (box.Min.z + box.Max.z) + offset.z;
+        extentX[c] = 0.5f * (box.Max.x - box.Min.x);
+        extentY[c] = 0.5f * (box.Max.y - box.Min.y);
+        extentZ[c] = 0.5f * (box.Max.z - box.Min.z);
+    }
+    frustum.CullBoxes(centerX, centerY, centerZ, extentX, extentY, extentZ, chunks, m_Visible.data());
+
+    m_Offsets.assign((size_t)m_Pool.Slots() * 3, 0.0f);
+    m_Firsts.clear();
+    m_Counts.clear();
+    m_Uploads.clear();
+    for (unsigned int c = 0; c < chunks; c++)
+    {
+        // an evicted chunk back in view is written again from the CPU copy
+        if (!m_Visible[c] || !m_Table.Prepare(c, m_Uploads))
+            continue;
+        unsigned int first = c * Trajectory::CHUNK_POINTS;
+        unsigned int last = std::min(m_Table.Count(), first + Trajectory::CHUNK_POINTS);
+        unsigned int slot = m_Table.Slot(c);
+        Vec3 offset = Vec3Cast<float>(origins[c] - eye);
+        m_Offsets[(size_t)slot * 3 + 0] = offset.x;
+        m_Offsets[(size_t)slot * 3 + 1] = offset.y;
+        m_Offsets[(size_t)slot * 3 + 2] = offset.z;
+        m_Firsts.push_back((int)(slot * Trajectory::CHUNK_POINTS));
+        m_Counts.push_back((int)(last - first));
+    }
+    m_Pool.Upload(m_Uploads, m_Points);
+    if (m_Firsts.empty())
+        return 0;
+
+    glUniform3fv(slotOffsetsLocation, (GLsizei)m_Pool.Slots(), m_Offsets.data());
+    glBindVertexArray(m_Pool.VertexArray());
+    glMultiDrawArrays(GL_LINE_STRIP, m_Firsts.data(), m_Counts.data(), (GLsizei)m_Firsts.size());
+    glBindVertexArray(0);
+    return (unsigned int)m_Firsts.size();
+}
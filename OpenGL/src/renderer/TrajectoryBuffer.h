@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+
+#include "sim/ChunkSlots.h"
+#include "sim/Frustum.h"
+#include "sim/Trajectory.h"
+
+/* GPU storage for chunked trajectories (sim/Trajectory.h): one vertex
+   buffer split into fixed slots of Trajectory::CHUNK_POINTS vertices,
+   handed out to the chunks of any number of trajectories. Points are
+   appended into a chunk's slot in place, so growth never copies old
+   data. Which chunk holds which slot, and what is evicted when they run
+   out, is decided by ChunkSlotPool (sim/ChunkSlots.h).
+   Trajectory.shader indexes its offsets by slot, so it is built for
+   exactly this many slots. GL thread only. */
+class TrajectoryChunkPool
+{
+public:
+    explicit TrajectoryChunkPool(unsigned int slots);
+    ~TrajectoryChunkPool();
+
+    TrajectoryChunkPool(const TrajectoryChunkPool&) = delete;
+    TrajectoryChunkPool& operator=(const TrajectoryChunkPool&) = delete;
+
+    unsigned int Slots() const { return m_Slots.Slots(); }
+    unsigned int VertexArray() const { return m_VAO; }
+    unsigned long long Evictions() const { return m_Slots.Evictions(); }
+
+    // once per frame before drawing; chunks drawn in the current frame are never evicted
+    void BeginFrame() { m_Slots.BeginFrame(); }
+    // frees the GL objects while the context is still current; the destructor does it otherwise
+    void DeleteBuffers();
+
+private:
+    friend class TrajectoryBuffer;
+
+    // copies the points of each write to its slot
+    void Upload(const std::vector<ChunkSlotTable::Upload>& uploads, const float* points);
+
+    ChunkSlotPool m_Slots;
+    unsigned int m_VAO;
+    unsigned int m_VBO;
+};
+
+/* One trajectory's chunks in a TrajectoryChunkPool, with the per-chunk
+   bounds used to cull them. Draw submits every visible chunk as its own
+   strip in a single glMultiDrawArrays. */
+class TrajectoryBuffer
+{
+public:
+    explicit TrajectoryBuffer(TrajectoryChunkPool& pool);
+
+    TrajectoryBuffer(const TrajectoryBuffer&) = delete;
+    TrajectoryBuffer& operator=(const TrajectoryBuffer&) = delete;
+
+    // uploads points [Uploaded(), count); points must stay valid and unchanged below count (as Trajectory guarantees)
+    void Append(const float* points, unsigned int count);
+    unsigned int Uploaded() const { return m_Table.Count(); }
+
+    // draws the chunks that may be visible with the trajectory program bound; returns how many were drawn.
+    // slotOffsetsLocation is the shader's per-slot offset array, set to chunk origin minus eye
+    unsigned int Draw(const Vec3D* origins, const Vec3D& eye, const Frustum& frustum, int slotOffsetsLocation);
+
+private:
+    TrajectoryChunkPool& m_Pool;
+    ChunkSlotTable m_Table;
+    const float* m_Points;
+    std::vector<Aabb> m_Bounds; // per chunk, relative to the chunk origin
+
+    // per-draw scratch, kept to avoid allocating every frame
+    std::vector<ChunkSlotTable::Upload> m_Uploads;
+    std::vector<float> m_Boxes;
+    std::vector<unsigned char> m_Visible;
+    std::vector<float> m_Offsets;
+    std::vector<int> m_Firsts;
+    std::vector<int> m_Counts;
+};
@@ -0,0 +1,153 @@
+#include "renderer/TrajectoryGenerator.h"
+
+#include <iostream>
+
+#include <GL/glew.h>
+
+#include "sim/Physics.h"
+
+// per ball: position xyz, velocity xyz, k
+static const int LAUNCH_FLOATS = 7;
+
+TrajectoryGenerator::TrajectoryGenerator()
+    : m_PointsCapacity(0), m_Balls(0), m_Points(0), m_ReportedNoProgram(false)
+{
+    glGenVertexArrays(1, &m_LaunchVAO);
+    glGenBuffers(1, &m_LaunchVBO);
+    glBindVertexArray(m_LaunchVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_LaunchVBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * LAUNCH_FLOATS, (void*)0);
+    glVertexAttribDivisor(0, 1);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(float) * LAUNCH_FLOATS, (void*)(3 * sizeof(float)));
+    glVertexAttribDivisor(1, 1);
+
+    glGenVertexArrays(1, &m_PointsVAO);
+    glGenBuffers(1, &m_PointsVBO);
+    glBindVertexArray(m_PointsVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_PointsVBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)0);
+    glBindVertexArray(0);
+}
+
+TrajectoryGenerator::~TrajectoryGenerator()
+{
+    DeleteBuffers();
+}
+
+void TrajectoryGenerator::DeleteBuffers()
+{
+    const unsigned int buffers[] = { m_LaunchVBO, m_PointsVBO };
+    const unsigned int arrays[] = { m_LaunchVAO, m_PointsVAO };
+    if (m_LaunchVBO)
+    {
+        glDeleteBuffers(2, buffers);
+        glDeleteVertexArrays(2, arrays);
+    }
+    m_LaunchVBO = m_PointsVBO = m_LaunchVAO = m_PointsVAO = 0;
+}
+
+void TrajectoryGenerator::Generate(unsigned int program, const std::vector<AnalyticLaunch>& launches, const Vec3& gravity, float dt, unsigned int points)
+{
+    m_Balls = (unsigned int)launches.size();
+    m_Points = points;
+    if (m_Balls == 0 || m_Points == 0)
+        return;
+
+    m_Firsts.resize(m_Balls);
+    m_Counts.assign(m_Balls, (int)m_Points);
+    for (unsigned int b = 0; b < m_Balls; b++)
+        m_Firsts[b] = (int)(b * m_Points);
+
+    // launch positions go up relative to the first one, so the GPU works with small floats
+    m_Origin = launches[0].Position;
+    if (program == 0)
+    {
+        if (!m_ReportedNoProgram)
+            std::cout << "AnalyticTrajectory.shader did not build, generating analytic trajectories on the CPU" << std::endl;
+        m_ReportedNoProgram = true;
+        GenerateOnCpu(launches, gravity, dt);
+        return;
+    }
+
+    m_LaunchData.resize((size_t)m_Balls * LAUNCH_FLOATS);
+    for (unsigned int b = 0; b < m_Balls; b++)
+    {
+        const AnalyticLaunch& launch = launches[b];
+        Vec3 position = Vec3Cast<float>(launch.Position - m_Origin);
+        float* out = m_LaunchData.data() + (size_t)b * LAUNCH_FLOATS;
+        out[0] = position.x;
+        out[1] = position.y;
+        out[2] = position.z;
+        out[3] = (float)launch.Velocity.x;
+        out[4] = (float)launch.Velocity.y;
+        out[5] = (float)launch.Velocity.z;
+        out[6] = launch.K;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_LaunchVBO);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(m_LaunchData.size() * sizeof(float)), m_LaunchData.data(), GL_STREAM_DRAW);
+
+    size_t bytes = ReservePoints();
+
+    // instance b, vertex i lands at b * points + i
+    glUseProgram(program);
+    glUniform3f(glGetUniformLocation(program, "gravity"), gravity.x, gravity.y, gravity.z);
+    glUniform1f(glGetUniformLocation(program, "timeStep"), dt);
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(m_LaunchVAO);
+    glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_PointsVBO, 0, (GLsizeiptr)bytes);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArraysInstanced(GL_POINTS, 0, (GLsizei)m_Points, (GLsizei)m_Balls);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+}
+
+size_t TrajectoryGenerator::ReservePoints()
+{
+    // grow only; a smaller run reuses the buffer
+    size_t bytes = (size_t)m_Balls * m_Points * 3 * sizeof(float);
+    glBindBuffer(GL_ARRAY_BUFFER, m_PointsVBO);
+    if (bytes > m_PointsCapacity)
+    {
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)bytes, nullptr, GL_STATIC_DRAW);
+        m_PointsCapacity = bytes;
+    }
+    return bytes;
+}
+
+void TrajectoryGenerator::GenerateOnCpu(const std::vector<AnalyticLaunch>& launches, const Vec3& gravity, float dt)
+{
+    // the shader's formula in double, each sample straight from the launch
+    Vec3D g = Vec3Cast<double>(gravity);
+    std::vector<float> points((size_t)m_Balls * m_Points * 3);
+    for (unsigned int b = 0; b < m_Balls; b++)
+    {
+        const AnalyticLaunch& launch = launches[b];
+        float* out = points.data() + (size_t)b * m_Points * 3;
+        for (unsigned int i = 0; i < m_Points; i++)
+        {
+            BallStateD ball;
+            ball.Position = launch.Position - m_Origin;
+            ball.Velocity = launch.Velocity;
+            AdvanceAnalytic(ball, g, (double)launch.K, (double)i * dt);
+            out[3 * i + 0] = (float)ball.Position.x;
+            out[3 * i + 1] = (float)ball.Position.y;
+            out[3 * i + 2] = (float)ball.Position.z;
+        }
+    }
+    size_t bytes = ReservePoints();
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)bytes, points.data());
+}
+
+void TrajectoryGenerator::Draw() const
+{
+    if (m_Balls == 0 || m_Points == 0)
+        return;
+    glBindVertexArray(m_PointsVAO);
+    glMultiDrawArrays(GL_LINE_STRIP, m_Firsts.data(), m_Counts.data(), (GLsizei)m_Balls);
+    glBindVertexArray(0);
+}
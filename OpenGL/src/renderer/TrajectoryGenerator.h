@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+#include "sim/Vec3.h"
+
+/* Initial conditions of one ball for GPU trajectory generation. */
+struct AnalyticLaunch
+{
+    Vec3D Position;
+    Vec3D Velocity;
+    float K = 0.0f; // linear drag over mass, 0 for none
+};
+
+/* Evaluates closed-form drag trajectories on the GPU. One transform
+   feedback pass with rasterization off (AnalyticTrajectory.shader) writes
+   every sample of every ball straight into a vertex buffer, so the CPU
+   uploads seven floats per ball instead of each point. The flights are
+   free (no ground contact), as in the analytic solution. Points are
+   relative to Origin(), like trajectory chunks, and draw with any
+   program built on Transform.glsl given originOffset = Origin() - eye.
+   GL thread only. */
+class TrajectoryGenerator
+{
+public:
+    TrajectoryGenerator();
+    ~TrajectoryGenerator();
+
+    TrajectoryGenerator(const TrajectoryGenerator&) = delete;
+    TrajectoryGenerator& operator=(const TrajectoryGenerator&) = delete;
+
+    /* Samples each ball at t = 0, dt, ..., (points - 1) dt; program is the
+       linked AnalyticTrajectory.shader. With program 0 (the shader failed
+       to build) the same points are computed on the CPU and uploaded. */
+    void Generate(unsigned int program, const std::vector<AnalyticLaunch>& launches, const Vec3& gravity, float dt, unsigned int points);
+    // one line strip per ball in a single glMultiDrawArrays, with the drawing program bound
+    void Draw() const;
+
+    const Vec3D& Origin() const { return m_Origin; }
+    unsigned int Balls() const { return m_Balls; }
+    unsigned int Points() const { return m_Points; }
+
+    // frees the GL objects while the context is still current; the destructor does it otherwise
+    void DeleteBuffers();
+
+private:
+    // sizes the point buffer for m_Balls * m_Points and leaves it bound; returns the bytes used
+    size_t ReservePoints();
+    void GenerateOnCpu(const std::vector<AnalyticLaunch>& launches, const Vec3& gravity, float dt);
+
+    unsigned int m_LaunchVAO;
+    unsigned int m_LaunchVBO;
+    unsigned int m_PointsVAO;
+    unsigned int m_PointsVBO;
+    size_t m_PointsCapacity; // bytes
+    Vec3D m_Origin;
+    unsigned int m_Balls;
+    unsigned int m_Points;
+    bool m_ReportedNoProgram;
+    std::vector<float> m_LaunchData;
+    std::vector<int> m_Firsts;
+    std::vector<int> m_Counts;
+};
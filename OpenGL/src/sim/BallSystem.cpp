@@ -0,0 +1,143 @@
+#include "sim/BallSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "sim/ForceField.h"
+#include "sim/SweepAndPrune.h"
+#include "sim/UniformGrid.h"
+
+void BallSystem::Reserve(size_t count)
+{
+    PosX.reserve(count); PosY.reserve(count); PosZ.reserve(count);
+    VelX.reserve(count); VelY.reserve(count); VelZ.reserve(count);
+    SpinX.reserve(count); SpinY.reserve(count); SpinZ.reserve(count);
+    Radius.reserve(count);
+    InvMass.reserve(count);
+    Resting.reserve(count);
+}
+
+void BallSystem::Clear()
+{
+    PosX.clear(); PosY.clear(); PosZ.clear();
+    VelX.clear(); VelY.clear(); VelZ.clear();
+    SpinX.clear(); SpinY.clear(); SpinZ.clear();
+    Radius.clear();
+    InvMass.clear();
+    Resting.clear();
+}
+
+size_t BallSystem::Add(const Vec3& position, const Vec3& velocity, float radius, float mass, const Vec3& spin)
+{
+    PosX.push_back(position.x); PosY.push_back(position.y); PosZ.push_back(position.z);
+    VelX.push_back(velocity.x); VelY.push_back(velocity.y); VelZ.push_back(velocity.z);
+    SpinX.push_back(spin.x); SpinY.push_back(spin.y); SpinZ.push_back(spin.z);
+    Radius.push_back(radius);
+    InvMass.push_back(1.0f / mass);
+    Resting.push_back(0);
+    return PosX.size() - 1;
+}
+
+float BallSystem::MaxRadius() const
+{
+    return Radius.empty() ? 0.0f : *std::max_element(Radius.begin(), Radius.end());
+}
+
+std::unique_ptr<BroadPhase> CreateBroadPhase(BroadPhaseType type)
+{
+    if (type == BroadPhaseType::SWEEP_AND_PRUNE)
+        return std::unique_ptr<BroadPhase>(new SweepAndPrune());
+    return std::unique_ptr<BroadPhase>(new UniformGrid());
+}
+
+void ResolveCollisions(BallSystem& balls, const std::vector<BallPair>& pairs, float restitution)
+{
+    // share of the penetration removed per step, and the overlap left alone to avoid jitter
+    const float CORRECTION = 0.8f;
+    const float SLOP = 0.001f;
+
+    for (const BallPair& pair : pairs)
+    {
+        const uint32_t a = pair.A, b = pair.B;
+        float dx = balls.PosX[b] - balls.PosX[a];
+        float dy = balls.PosY[b] - balls.PosY[a];
+        float dz = balls.PosZ[b] - balls.PosZ[a];
+        float distance2 = dx * dx + dy * dy + dz * dz;
+        float radii = balls.Radius[a] + balls.Radius[b];
+        // earlier pairs this step may already have separated them
+        if (distance2 >= radii * radii || distance2 == 0.0f)
+            continue;
+
+        float distance = std::sqrt(distance2);
+        float nx = dx / distance, ny = dy / distance, nz = dz / distance;
+        float invMassA = balls.InvMass[a], invMassB = balls.InvMass[b];
+        float invMassSum = invMassA + invMassB;
+        if (invMassSum == 0.0f)
+            continue;
+
+        float push = std::max(radii - distance - SLOP, 0.0f) * CORRECTION / invMassSum;
+        balls.PosX[a] -= nx * push * invMassA; balls.PosY[a] -= ny * push * invMassA; balls.PosZ[a] -= nz * push * invMassA;
+        balls.PosX[b] += nx * push * invMassB; balls.PosY[b] += ny * push * invMassB; balls.PosZ[b] += nz * push * invMassB;
+
+        float approach = (balls.VelX[b] - balls.VelX[a]) * nx + (balls.VelY[b] - balls.VelY[a]) * ny + (balls.VelZ[b] - balls.VelZ[a]) * nz;
+        if (approach >= 0.0f)
+            continue; // already separating
+
+        float impulse = -(1.0f + restitution) * approach / invMassSum;
+        balls.VelX[a] -= nx * impulse * invMassA; balls.VelY[a] -= ny * impulse * invMassA; balls.VelZ[a] -= nz * impulse * invMassA;
+        balls.VelX[b] += nx * impulse * invMassB; balls.VelY[b] += ny * impulse * invMassB; balls.VelZ[b] += nz * impulse * invMassB;
+        balls.Resting[a] = 0;
+        balls.Resting[b] = 0;
+    }
+}
+
+size_t StepBallSystem(BallSystem& balls, const ForceFieldStack& forces, const GroundPlane& ground, float restitution, float dt, BroadPhase& broadPhase,
+                      std::vector<BallPair>& pairs, std::vector<GroundedBall>& grounded)
+{
+    grounded.clear();
+
+    // forces for a batch, then semi-implicit Euler for every ball that stays above the ground
+    float accX[FORCE_BATCH], accY[FORCE_BATCH], accZ[FORCE_BATCH];
+    const size_t count = balls.Size();
+    for (size_t begin = 0; begin < count; begin += FORCE_BATCH)
+    {
+        const size_t batch = std::min(FORCE_BATCH, count - begin);
+        forces.Evaluate(balls, begin, batch, accX, accY, accZ);
+        for (size_t j = 0; j < batch; j++)
+        {
+            const size_t i = begin + j;
+            if (balls.Resting[i])
+                continue;
+            float vx = balls.VelX[i] + dt * accX[j];
+            float vy = balls.VelY[i] + dt * accY[j];
+            float vz = balls.VelZ[i] + dt * accZ[j];
+            float y = balls.PosY[i] + dt * vy;
+            if (y <= ground.Height + balls.Radius[i])
+            {
+                grounded.push_back({ (uint32_t)i, Vec3(accX[j], accY[j], accZ[j]) });
+                continue;
+            }
+            balls.VelX[i] = vx; balls.VelY[i] = vy; balls.VelZ[i] = vz;
+            balls.PosX[i] += dt * vx;
+            balls.PosY[i] = y;
+            balls.PosZ[i] += dt * vz;
+        }
+    }
+
+    // the few touching the ground: impact solved exactly for the step's constant acceleration
+    for (const GroundedBall& entry : grounded)
+    {
+        const uint32_t i = entry.Ball;
+        BallState ball;
+        ball.Position = balls.Position(i);
+        ball.Velocity = balls.Velocity(i);
+        StepWithGround(ball, entry.Acceleration, 0.0f, balls.Radius[i], ground, dt);
+        balls.PosX[i] = ball.Position.x; balls.PosY[i] = ball.Position.y; balls.PosZ[i] = ball.Position.z;
+        balls.VelX[i] = ball.Velocity.x; balls.VelY[i] = ball.Velocity.y; balls.VelZ[i] = ball.Velocity.z;
+        balls.Resting[i] = ball.Resting ? 1 : 0;
+    }
+
+    broadPhase.FindPairs(balls, pairs);
+    ResolveCollisions(balls, pairs, restitution);
+    return pairs.size();
+}
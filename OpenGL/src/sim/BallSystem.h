@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "sim/Physics.h"
+
+/* Many balls stored as structure of arrays, so the integration loops
+   stream through memory and vectorize. Index i is the same ball in
+   every array. */
+struct BallSystem
+{
+    std::vector<float> PosX, PosY, PosZ;
+    std::vector<float> VelX, VelY, VelZ;
+    std::vector<float> SpinX, SpinY, SpinZ; // angular velocity, rad/s
+    std::vector<float> Radius;
+    std::vector<float> InvMass;
+    std::vector<uint8_t> Resting;
+
+    size_t Size() const { return PosX.size(); }
+    void Reserve(size_t count);
+    void Clear();
+    // returns the index of the new ball
+    size_t Add(const Vec3& position, const Vec3& velocity, float radius, float mass, const Vec3& spin = Vec3());
+
+    Vec3 Position(size_t i) const { return Vec3(PosX[i], PosY[i], PosZ[i]); }
+    Vec3 Velocity(size_t i) const { return Vec3(VelX[i], VelY[i], VelZ[i]); }
+    float MaxRadius() const;
+};
+
+struct BallPair
+{
+    uint32_t A, B; // A < B
+};
+
+/* Potentially colliding pairs; implementations return every pair whose
+   spheres overlap, each once. */
+class BroadPhase
+{
+public:
+    virtual ~BroadPhase() {}
+    virtual void FindPairs(const BallSystem& balls, std::vector<BallPair>& pairs) = 0;
+};
+
+enum class BroadPhaseType
+{
+    GRID = 0, SWEEP_AND_PRUNE = 1
+};
+
+std::unique_ptr<BroadPhase> CreateBroadPhase(BroadPhaseType type);
+
+// sphere-sphere test and impulse response for the pairs, restitution e in [0, 1]
+void ResolveCollisions(BallSystem& balls, const std::vector<BallPair>& pairs, float restitution);
+
+// a ball reaching the ground this step, with the acceleration it had
+struct GroundedBall
+{
+    uint32_t Ball;
+    Vec3 Acceleration;
+};
+
+class ForceFieldStack;
+
+/* One step: the force fields for every ball, the ground, then ball-ball
+   collisions found by the broad phase. The stack is built once by the
+   caller (DefaultForces for gravity and linear drag); pairs and grounded
+   are scratch kept by the caller so steps do not allocate. Returns the
+   number of colliding pairs. */
+size_t StepBallSystem(BallSystem& balls, const ForceFieldStack& forces, const GroundPlane& ground, float restitution, float dt, BroadPhase& broadPhase,
+                      std::vector<BallPair>& pairs, std::vector<GroundedBall>& grounded);
@@ -0,0 +1,103 @@
+#include "sim/ChunkSlots.h"
+
+#include <algorithm>
+
+const unsigned int ChunkSlotPool::NO_SLOT;
+
+ChunkSlotPool::ChunkSlotPool(unsigned int slots)
+    : m_Entries(slots), m_Frame(1), m_Evictions(0)
+{
+}
+
+unsigned int ChunkSlotPool::Acquire(ChunkSlotTable* owner, unsigned int chunk)
+{
+    unsigned int victim = NO_SLOT;
+    for (unsigned int slot = 0; slot < Slots(); slot++)
+    {
+        const Entry& entry = m_Entries[slot];
+        if (!entry.Owner)
+        {
+            victim = slot;
+            break;
+        }
+        if (entry.LastDrawn == m_Frame || entry.Owner->IsOpen(entry.Chunk))
+            continue;
+        if (victim == NO_SLOT || entry.LastDrawn < m_Entries[victim].LastDrawn)
+            victim = slot;
+    }
+    if (victim == NO_SLOT)
+        return NO_SLOT;
+
+    Entry& entry = m_Entries[victim];
+    if (entry.Owner)
+    {
+        entry.Owner->Evicted(entry.Chunk);
+        m_Evictions++;
+    }
+    entry.Owner = owner;
+    entry.Chunk = chunk;
+    entry.LastDrawn = 0;
+    return victim;
+}
+
+ChunkSlotTable::ChunkSlotTable(ChunkSlotPool& pool)
+    : m_Pool(pool), m_Count(0)
+{
+}
+
+ChunkSlotTable::~ChunkSlotTable()
+{
+    for (unsigned int slot : m_Slots)
+        if (slot != ChunkSlotPool::NO_SLOT)
+            m_Pool.Release(slot);
+}
+
+bool ChunkSlotTable::IsOpen(unsigned int chunk) const
+{
+    return chunk + 1 == m_Slots.size() && m_Count % Trajectory::CHUNK_POINTS != 0;
+}
+
+bool ChunkSlotTable::Place(unsigned int chunk, unsigned int from, unsigned int to, std::vector<Upload>& uploads)
+{
+    if (m_Slots[chunk] == ChunkSlotPool::NO_SLOT)
+    {
+        // a fresh slot holds nothing yet: the whole chunk up to 'to' goes in
+        m_Slots[chunk] = m_Pool.Acquire(this, chunk);
+        if (m_Slots[chunk] == ChunkSlotPool::NO_SLOT)
+            return false;
+        from = chunk * Trajectory::CHUNK_POINTS;
+    }
+    uploads.push_back({ m_Slots[chunk], from, to });
+    return true;
+}
+
+void ChunkSlotTable::Append(unsigned int count, std::vector<Upload>& uploads)
+{
+    if (count <= m_Count)
+        return;
+    m_Slots.resize(Trajectory::ChunkCount(count), ChunkSlotPool::NO_SLOT);
+
+    unsigned int from = m_Count;
+    m_Count = count;
+    while (from < count)
+    {
+        // one contiguous write per chunk
+        unsigned int chunk = from / Trajectory::CHUNK_POINTS;
+        unsigned int to = std::min(count, (chunk + 1) * Trajectory::CHUNK_POINTS);
+        Place(chunk, from, to, uploads);
+        from = to;
+    }
+}
+
+bool ChunkSlotTable::Prepare(unsigned int chunk, std::vector<Upload>& uploads)
+{
+    // evicted earlier and back in view: the points are still on the CPU
+    if (m_Slots[chunk] == ChunkSlotPool::NO_SLOT)
+    {
+        unsigned int first = chunk * Trajectory::CHUNK_POINTS;
+        if (!Place(chunk, first, std::min(m_Count, first + Trajectory::CHUNK_POINTS), uploads))
+            return false;
+    }
+    m_Pool.Touch(m_Slots[chunk]);
+    return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+
+#include "sim/Trajectory.h"
+
+class ChunkSlotTable;
+
+/* Bookkeeping for a fixed number of slots, each holding one trajectory
+   chunk (Trajectory::CHUNK_POINTS points), shared by any number of
+   trajectories. When every slot is taken, the least recently drawn
+   finished chunk is evicted; a chunk drawn in the current frame or still
+   receiving points never is. GL-free: TrajectoryChunkPool keeps the
+   vertex buffer these slots index. */
+class ChunkSlotPool
+{
+public:
+    static const unsigned int NO_SLOT = ~0u;
+
+    explicit ChunkSlotPool(unsigned int slots);
+
+    unsigned int Slots() const { return (unsigned int)m_Entries.size(); }
+    // once per frame before drawing
+    void BeginFrame() { m_Frame++; }
+    unsigned long long Frame() const { return m_Frame; }
+    // chunks pushed out of their slot so far
+    unsigned long long Evictions() const { return m_Evictions; }
+
+    // who holds a slot; nullptr when it is free
+    const ChunkSlotTable* Owner(unsigned int slot) const { return m_Entries[slot].Owner; }
+    unsigned int Chunk(unsigned int slot) const { return m_Entries[slot].Chunk; }
+    unsigned long long LastDrawn(unsigned int slot) const { return m_Entries[slot].LastDrawn; }
+
+private:
+    friend class ChunkSlotTable;
+
+    struct Entry
+    {
+        ChunkSlotTable* Owner = nullptr;
+        unsigned int Chunk = 0;
+        unsigned long long LastDrawn = 0;
+    };
+
+    // a free slot, else one taken from the least recently drawn evictable chunk; NO_SLOT if there is none
+    unsigned int Acquire(ChunkSlotTable* owner, unsigned int chunk);
+    void Release(unsigned int slot) { m_Entries[slot].Owner = nullptr; }
+    void Touch(unsigned int slot) { m_Entries[slot].LastDrawn = m_Frame; }
+
+    std::vector<Entry> m_Entries;
+    unsigned long long m_Frame;
+    unsigned long long m_Evictions;
+};
+
+/* The slot of every chunk of one trajectory. Append and Prepare only
+   decide what has to be written where; the caller copies points
+   [From, To) to slot Slot, starting From - chunk * CHUNK_POINTS points
+   into it. */
+class ChunkSlotTable
+{
+public:
+    struct Upload
+    {
+        unsigned int Slot;
+        unsigned int From; // first point, index into the whole trajectory
+        unsigned int To;   // one past the last point, within the same chunk
+    };
+
+    explicit ChunkSlotTable(ChunkSlotPool& pool);
+    ~ChunkSlotTable();
+
+    ChunkSlotTable(const ChunkSlotTable&) = delete;
+    ChunkSlotTable& operator=(const ChunkSlotTable&) = delete;
+
+    unsigned int Count() const { return m_Count; }
+    unsigned int Chunks() const { return (unsigned int)m_Slots.size(); }
+    // NO_SLOT while the chunk is not resident
+    unsigned int Slot(unsigned int chunk) const { return m_Slots[chunk]; }
+    // the last chunk still receives points until it is full
+    bool IsOpen(unsigned int chunk) const;
+
+    /* The trajectory grew to count points: adds the writes for points
+       [Count(), count), one per chunk. A chunk that gets no slot is
+       skipped and written whole when it is next drawn. */
+    void Append(unsigned int count, std::vector<Upload>& uploads);
+    /* A chunk is about to be drawn this frame: marks it used, and if it
+       was evicted takes a slot back and adds a write of the whole chunk.
+       False if no slot can be had. */
+    bool Prepare(unsigned int chunk, std::vector<Upload>& uploads);
+
+private:
+    friend class ChunkSlotPool;
+
+    void Evicted(unsigned int chunk) { m_Slots[chunk] = ChunkSlotPool::NO_SLOT; }
+    // acquires a slot for a chunk without one; the write then starts at the chunk's first point
+    bool Place(unsigned int chunk, unsigned int from, unsigned int to, std::vector<Upload>& uploads);
+
+    ChunkSlotPool& m_Pool;
+    unsigned int m_Count;
+    std::vector<unsigned int> m_Slots; // per chunk
+};
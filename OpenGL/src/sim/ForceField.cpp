@@ -0,0 +1,192 @@
+#include "sim/ForceField.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const float PI = 3.14159265358979f;
+
+/* The kernels take __restrict parameters: the accumulators never alias
+   the inputs, and saying so lets the loops vectorize without runtime
+   overlap checks (compilers honour restrict reliably only on parameters). */
+
+static void GravityKernel(size_t count, float gx, float gy, float gz,
+    float* __restrict accX, float* __restrict accY, float* __restrict accZ)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        accX[i] += gx;
+        accY[i] += gy;
+        accZ[i] += gz;
+    }
+}
+
+static void LinearDragKernel(size_t count, float beta, const float* __restrict invMass,
+    const float* __restrict velX, const float* __restrict velY, const float* __restrict velZ,
+    float* __restrict accX, float* __restrict accY, float* __restrict accZ)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const float k = beta * invMass[i];
+        accX[i] += -k * velX[i];
+        accY[i] += -k * velY[i];
+        accZ[i] += -k * velZ[i];
+    }
+}
+
+static void QuadraticDragKernel(size_t count, float c, const float* __restrict invMass, const float* __restrict radius, const float* __restrict density,
+    const float* __restrict velX, const float* __restrict velY, const float* __restrict velZ,
+    float* __restrict accX, float* __restrict accY, float* __restrict accZ)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const float vx = velX[i], vy = velY[i], vz = velZ[i];
+        const float speed = std::sqrt(vx * vx + vy * vy + vz * vz);
+        const float r = radius[i];
+        const float k = c * density[i] * r * r * speed * invMass[i];
+        accX[i] -= k * vx;
+        accY[i] -= k * vy;
+        accZ[i] -= k * vz;
+    }
+}
+
+static void MagnusKernel(size_t count, float c, const float* __restrict invMass, const float* __restrict radius, const float* __restrict density,
+    const float* __restrict velX, const float* __restrict velY, const float* __restrict velZ,
+    const float* __restrict spinX, const float* __restrict spinY, const float* __restrict spinZ,
+    float* __restrict accX, float* __restrict accY, float* __restrict accZ)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const float vx = velX[i], vy = velY[i], vz = velZ[i];
+        const float wx = spinX[i], wy = spinY[i], wz = spinZ[i];
+        const float r = radius[i];
+        const float k = c * density[i] * r * r * r * invMass[i];
+        accX[i] += k * (wy * vz - wz * vy);
+        accY[i] += k * (wz * vx - wx * vz);
+        accZ[i] += k * (wx * vy - wy * vx);
+    }
+}
+
+void UniformGravity::Accumulate(const ForceBatch& batch) const
+{
+    GravityKernel(batch.Count, m_Gravity.x, m_Gravity.y, m_Gravity.z, batch.AccX, batch.AccY, batch.AccZ);
+}
+
+void LinearDrag::Accumulate(const ForceBatch& batch) const
+{
+    LinearDragKernel(batch.Count, m_Beta, batch.InvMass, batch.VelX, batch.VelY, batch.VelZ, batch.AccX, batch.AccY, batch.AccZ);
+}
+
+void QuadraticDrag::Accumulate(const ForceBatch& batch) const
+{
+    QuadraticDragKernel(batch.Count, 0.5f * m_DragCoefficient * PI, batch.InvMass, batch.Radius, batch.Density,
+        batch.VelX, batch.VelY, batch.VelZ, batch.AccX, batch.AccY, batch.AccZ);
+}
+
+void MagnusLift::Accumulate(const ForceBatch& batch) const
+{
+    MagnusKernel(batch.Count, m_LiftCoefficient * 4.0f / 3.0f * PI, batch.InvMass, batch.Radius, batch.Density,
+        batch.VelX, batch.VelY, batch.VelZ, batch.SpinX, batch.SpinY, batch.SpinZ, batch.AccX, batch.AccY, batch.AccZ);
+}
+
+WindGrid::WindGrid(const Vec3& origin, float cellSize, int sizeX, int sizeY, int sizeZ)
+    : m_Origin(origin), m_InvCellSize(1.0f / cellSize), m_Size{ std::max(sizeX, 1), std::max(sizeY, 1), std::max(sizeZ, 1) }
+{
+    size_t count = (size_t)m_Size[0] * m_Size[1] * m_Size[2];
+    m_U.assign(count, 0.0f);
+    m_V.assign(count, 0.0f);
+    m_W.assign(count, 0.0f);
+}
+
+void WindGrid::Set(int x, int y, int z, const Vec3& wind)
+{
+    size_t index = ((size_t)z * m_Size[1] + y) * m_Size[0] + x;
+    m_U[index] = wind.x;
+    m_V[index] = wind.y;
+    m_W[index] = wind.z;
+}
+
+Vec3 WindGrid::Sample(float x, float y, float z) const
+{
+    const float p[3] = { (x - m_Origin.x) * m_InvCellSize, (y - m_Origin.y) * m_InvCellSize, (z - m_Origin.z) * m_InvCellSize };
+    int i0[3], i1[3];
+    float f[3];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float c = std::min(std::max(p[axis], 0.0f), (float)(m_Size[axis] - 1));
+        i0[axis] = std::min((int)c, m_Size[axis] - 1);
+        i1[axis] = std::min(i0[axis] + 1, m_Size[axis] - 1);
+        f[axis] = c - i0[axis];
+    }
+
+    Vec3 result;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        int cx = corner & 1 ? i1[0] : i0[0];
+        int cy = corner & 2 ? i1[1] : i0[1];
+        int cz = corner & 4 ? i1[2] : i0[2];
+        float weight = (corner & 1 ? f[0] : 1.0f - f[0]) * (corner & 2 ? f[1] : 1.0f - f[1]) * (corner & 4 ? f[2] : 1.0f - f[2]);
+        size_t index = ((size_t)cz * m_Size[1] + cy) * m_Size[0] + cx;
+        result += weight * Vec3(m_U[index], m_V[index], m_W[index]);
+    }
+    return result;
+}
+
+void ForceFieldStack::Evaluate(const BallSystem& balls, size_t begin, size_t count, float* accX, float* accY, float* accZ) const
+{
+    float density[FORCE_BATCH];
+    float relX[FORCE_BATCH], relY[FORCE_BATCH], relZ[FORCE_BATCH];
+
+    const float* posY = balls.PosY.data() + begin;
+    if (Air.ScaleHeight > 0.0f)
+    {
+        const float invScale = 1.0f / Air.ScaleHeight;
+        for (size_t i = 0; i < count; i++)
+            density[i] = Air.SurfaceDensity * std::exp((Air.SurfaceHeight - posY[i]) * invScale);
+    }
+    else
+    {
+        std::fill(density, density + count, Air.SurfaceDensity);
+    }
+
+    const float* velX = balls.VelX.data() + begin;
+    const float* velY = balls.VelY.data() + begin;
+    const float* velZ = balls.VelZ.data() + begin;
+    if (Air.Wind)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            Vec3 wind = Air.Wind->Sample(balls.PosX[begin + i], balls.PosY[begin + i], balls.PosZ[begin + i]);
+            relX[i] = velX[i] - wind.x;
+            relY[i] = velY[i] - wind.y;
+            relZ[i] = velZ[i] - wind.z;
+        }
+        velX = relX;
+        velY = relY;
+        velZ = relZ;
+    }
+
+    std::fill(accX, accX + count, 0.0f);
+    std::fill(accY, accY + count, 0.0f);
+    std::fill(accZ, accZ + count, 0.0f);
+
+    ForceBatch batch = {
+        count,
+        balls.PosX.data() + begin, posY, balls.PosZ.data() + begin,
+        velX, velY, velZ,
+        balls.SpinX.data() + begin, balls.SpinY.data() + begin, balls.SpinZ.data() + begin,
+        balls.Radius.data() + begin, balls.InvMass.data() + begin,
+        density,
+        accX, accY, accZ,
+    };
+    for (const std::unique_ptr<ForceField>& field : m_Fields)
+        field->Accumulate(batch);
+}
+
+ForceFieldStack DefaultForces(const PhysicsParams& params)
+{
+    ForceFieldStack forces;
+    forces.Air.ScaleHeight = 0.0f; // neither field reads the density
+    forces.Add(std::unique_ptr<ForceField>(new UniformGravity(params.Gravity)));
+    forces.Add(std::unique_ptr<ForceField>(new LinearDrag(params.Beta)));
+    return forces;
+}
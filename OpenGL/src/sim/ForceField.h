@@ -0,0 +1,122 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "sim/BallSystem.h"
+
+// balls evaluated together; scratch arrays of this size live on the stack
+const size_t FORCE_BATCH = 256;
+
+/* A run of consecutive balls as arrays, for force fields to add their
+   acceleration to. Velocities are relative to the air (wind already
+   subtracted) and Density is the air density at each ball. */
+struct ForceBatch
+{
+    size_t Count;
+    const float *PosX, *PosY, *PosZ;
+    const float *VelX, *VelY, *VelZ;
+    const float *SpinX, *SpinY, *SpinZ;
+    const float *Radius, *InvMass;
+    const float *Density;
+    float *AccX, *AccY, *AccZ;
+};
+
+/* One contribution to the acceleration of every ball. Implementations
+   loop over a whole batch with no per-ball virtual call, so each field
+   stays a plain vectorizable loop. */
+class ForceField
+{
+public:
+    virtual ~ForceField() {}
+    virtual void Accumulate(const ForceBatch& batch) const = 0;
+};
+
+class UniformGravity : public ForceField
+{
+public:
+    explicit UniformGravity(const Vec3& gravity) : m_Gravity(gravity) {}
+    void Accumulate(const ForceBatch& batch) const override;
+
+private:
+    Vec3 m_Gravity;
+};
+
+// -beta / mass * v, the demo's drag
+class LinearDrag : public ForceField
+{
+public:
+    explicit LinearDrag(float beta) : m_Beta(beta) {}
+    void Accumulate(const ForceBatch& batch) const override;
+
+private:
+    float m_Beta;
+};
+
+// -1/2 rho Cd A |v| v / mass, A = pi r^2
+class QuadraticDrag : public ForceField
+{
+public:
+    explicit QuadraticDrag(float dragCoefficient = 0.47f) : m_DragCoefficient(dragCoefficient) {}
+    void Accumulate(const ForceBatch& batch) const override;
+
+private:
+    float m_DragCoefficient;
+};
+
+// lift from spin: C * 4/3 pi r^3 rho (w x v) / mass
+class MagnusLift : public ForceField
+{
+public:
+    explicit MagnusLift(float liftCoefficient = 0.5f) : m_LiftCoefficient(liftCoefficient) {}
+    void Accumulate(const ForceBatch& batch) const override;
+
+private:
+    float m_LiftCoefficient;
+};
+
+/* Wind velocity on a regular 3D grid, sampled trilinearly and clamped
+   at the edges. */
+class WindGrid
+{
+public:
+    WindGrid(const Vec3& origin, float cellSize, int sizeX, int sizeY, int sizeZ);
+
+    void Set(int x, int y, int z, const Vec3& wind);
+    Vec3 Sample(float x, float y, float z) const;
+
+private:
+    Vec3 m_Origin;
+    float m_InvCellSize;
+    int m_Size[3];
+    std::vector<float> m_U, m_V, m_W;
+};
+
+/* Air shared by the drag and lift fields: density decays exponentially
+   with height, wind is optional. */
+struct Atmosphere
+{
+    float SurfaceDensity = 1.225f;
+    float SurfaceHeight = -50.0f; // the demo floor
+    float ScaleHeight = 8500.0f;  // 0 keeps the density constant
+    std::shared_ptr<const WindGrid> Wind;
+};
+
+/* The fields acting on a BallSystem, evaluated batch by batch. */
+class ForceFieldStack
+{
+public:
+    Atmosphere Air;
+
+    void Add(std::unique_ptr<ForceField> field) { m_Fields.push_back(std::move(field)); }
+    bool Empty() const { return m_Fields.empty(); }
+
+    // acceleration of balls [begin, begin + count), count <= FORCE_BATCH
+    void Evaluate(const BallSystem& balls, size_t begin, size_t count, float* accX, float* accY, float* accZ) const;
+
+private:
+    std::vector<std::unique_ptr<ForceField>> m_Fields;
+};
+
+// gravity plus linear drag (PhysicsParams::Mass and Radius are per ball in a BallSystem); build once, not per step
+ForceFieldStack DefaultForces(const PhysicsParams& params);
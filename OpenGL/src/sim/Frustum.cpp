@@ -0,0 +1,162 @@
+#include "sim/Frustum.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BALL_FRUSTUM_SSE 1
+#include <xmmintrin.h>
+#endif
+
+void ExtendChunkBounds(std::vector<Aabb>& bounds, const float* coords, unsigned int from, unsigned int to, unsigned int chunkPoints)
+{
+    for (unsigned int i = from; i < to; i++)
+    {
+        const float* p = coords + (size_t)i * 3;
+        Vec3 point(p[0], p[1], p[2]);
+        unsigned int chunk = i / chunkPoints;
+        if (chunk >= bounds.size())
+        {
+            bounds.push_back({ point, point });
+            continue;
+        }
+        Aabb& box = bounds[chunk];
+        box.Min = Vec3(std::min(box.Min.x, point.x), std::min(box.Min.y, point.y), std::min(box.Min.z, point.z));
+        box.Max = Vec3(std::max(box.Max.x, point.x), std::max(box.Max.y, point.y), std::max(box.Max.z, point.z));
+    }
+}
+
+Frustum::Frustum(const float* m)
+{
+    // Gribb-Hartmann: planes are the last row of the matrix plus or minus each of the others
+    for (int p = 0; p < 6; p++)
+    {
+        int row = p / 2;
+        float sign = p % 2 == 0 ? 1.0f : -1.0f;
+        float a = m[3] + sign * m[row];
+        float b = m[7] + sign * m[4 + row];
+        float c = m[11] + sign * m[8 + row];
+        float d = m[15] + sign * m[12 + row];
+        float length = std::sqrt(a * a + b * b + c * c);
+        float scale = length > 0.0f ? 1.0f / length : 0.0f;
+        m_A[p] = a * scale;
+        m_B[p] = b * scale;
+        m_C[p] = c * scale;
+        m_D[p] = d * scale;
+        m_AbsA[p] = std::fabs(m_A[p]);
+        m_AbsB[p] = std::fabs(m_B[p]);
+        m_AbsC[p] = std::fabs(m_C[p]);
+    }
+}
+
+// the SSE loops below evaluate these in the same order, so both agree bit for bit
+bool Frustum::BoxOutside(float cx, float cy, float cz, float ex, float ey, float ez) const
+{
+    for (int p = 0; p < 6; p++)
+    {
+        float distance = m_A[p] * cx + m_B[p] * cy + m_C[p] * cz + m_D[p];
+        float reach = m_AbsA[p] * ex + m_AbsB[p] * ey + m_AbsC[p] * ez;
+        if (distance + reach < 0.0f)
+            return true;
+    }
+    return false;
+}
+
+bool Frustum::SphereOutside(float x, float y, float z, float r) const
+{
+    for (int p = 0; p < 6; p++)
+    {
+        float distance = m_A[p] * x + m_B[p] * y + m_C[p] * z + m_D[p];
+        if (distance + r < 0.0f)
+            return true;
+    }
+    return false;
+}
+
+bool Frustum::TestSphere(const Vec3& center, float radius) const
+{
+    return !SphereOutside(center.x, center.y, center.z, radius);
+}
+
+bool Frustum::TestBox(const Aabb& box) const
+{
+    return !BoxOutside(0.5f * (box.Min.x + box.Max.x), 0.5f * (box.Min.y + box.Max.y), 0.5f * (box.Min.z + box.Max.z),
+                       0.5f * (box.Max.x - box.Min.x), 0.5f * (box.Max.y - box.Min.y), 0.5f * (box.Max.z - box.Min.z));
+}
+
+size_t Frustum::CullBoxes(const float* centerX, const float* centerY, const float* centerZ,
+                          const float* extentX, const float* extentY, const float* extentZ,
+                          size_t count, unsigned char* visible) const
+{
+    size_t i = 0, visibleCount = 0;
+#ifdef BALL_FRUSTUM_SSE
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(centerX + i), cy = _mm_loadu_ps(centerY + i), cz = _mm_loadu_ps(centerZ + i);
+        __m128 ex = _mm_loadu_ps(extentX + i), ey = _mm_loadu_ps(extentY + i), ez = _mm_loadu_ps(extentZ + i);
+        __m128 outside = zero;
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m_A[p]), cx), _mm_mul_ps(_mm_set1_ps(m_B[p]), cy)),
+                                                    _mm_mul_ps(_mm_set1_ps(m_C[p]), cz)), _mm_set1_ps(m_D[p]));
+            __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m_AbsA[p]), ex), _mm_mul_ps(_mm_set1_ps(m_AbsB[p]), ey)),
+                                      _mm_mul_ps(_mm_set1_ps(m_AbsC[p]), ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), zero));
+        }
+        int mask = _mm_movemask_ps(outside);
+        for (int k = 0; k < 4; k++)
+        {
+            visible[i + k] = (mask >> k & 1) ? 0 : 1;
+            visibleCount += visible[i + k];
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        visible[i] = BoxOutside(centerX[i], centerY[i], centerZ[i], extentX[i], extentY[i], extentZ[i]) ? 0 : 1;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+
+size_t Frustum::CullSpheres(const float* x, const float* y, const float* z, const float* radius,
+                            size_t count, unsigned char* visible) const
+{
+    size_t i = 0, visibleCount = 0;
+#ifdef BALL_FRUSTUM_SSE
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i), r = _mm_loadu_ps(radius + i);
+        __m128 outside = zero;
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m_A[p]), px), _mm_mul_ps(_mm_set1_ps(m_B[p]), py)),
+                                                    _mm_mul_ps(_mm_set1_ps(m_C[p]), pz)), _mm_set1_ps(m_D[p]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, r), zero));
+        }
+        int mask = _mm_movemask_ps(outside);
+        for (int k = 0; k < 4; k++)
+        {
+            visible[i + k] = (mask >> k & 1) ? 0 : 1;
+            visibleCount += visible[i + k];
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        visible[i] = SphereOutside(x[i], y[i], z[i], radius[i]) ? 0 : 1;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+
+bool FrustumSimdAvailable()
+{
+#ifdef BALL_FRUSTUM_SSE
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "sim/Vec3.h"
+
+struct Aabb
+{
+    Vec3 Min;
+    Vec3 Max;
+};
+
+// grows per-chunk bounds by points [from, to) of packed xyz coords, chunkPoints points per chunk
+void ExtendChunkBounds(std::vector<Aabb>& bounds, const float* coords, unsigned int from, unsigned int to, unsigned int chunkPoints);
+
+/* The six planes of a view frustum, taken from a column-major clip
+   matrix (projection * view, e.g. glm::value_ptr). Tests are
+   conservative: an object is culled only when it lies entirely outside
+   one plane. The batch tests take SoA arrays and run four objects per
+   SSE iteration; they agree exactly with the single-object tests. */
+class Frustum
+{
+public:
+    explicit Frustum(const float* clipMatrix);
+
+    bool TestSphere(const Vec3& center, float radius) const;
+    bool TestBox(const Aabb& box) const;
+
+    // visible[i] = 1 if box i (center, half extent) may be visible, else 0; returns the visible count
+    size_t CullBoxes(const float* centerX, const float* centerY, const float* centerZ,
+                     const float* extentX, const float* extentY, const float* extentZ,
+                     size_t count, unsigned char* visible) const;
+    // same for spheres, e.g. the position and radius arrays of a BallSystem
+    size_t CullSpheres(const float* x, const float* y, const float* z, const float* radius,
+                       size_t count, unsigned char* visible) const;
+
+private:
+    bool BoxOutside(float cx, float cy, float cz, float ex, float ey, float ez) const;
+    bool SphereOutside(float x, float y, float z, float r) const;
+
+    // plane p: A[p] x + B[p] y + C[p] z + D[p] >= 0 inside, normals of unit length
+    float m_A[6], m_B[6], m_C[6], m_D[6];
+    float m_AbsA[6], m_AbsB[6], m_AbsC[6];
+};
+
+// false when the build has no SIMD kernels for this CPU
+bool FrustumSimdAvailable();
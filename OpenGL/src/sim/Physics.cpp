@@ -0,0 +1,166 @@
+#include "sim/Physics.h"
+
+#include <cmath>
+
+template <typename T>
+static void StepEuler(BallStateT<T>& ball, const Vec3T<T>& gravity, T k, T dt)
+{
+    Vec3T<T> friction_accel = -k * ball.Velocity;
+    Vec3T<T> acceleration = friction_accel + gravity;
+    ball.Velocity += dt * acceleration;
+    ball.Position += dt * ball.Velocity;
+}
+
+template <typename T>
+void StepDrag(BallStateT<T>& ball, const PhysicsParamsT<T>& params, T dt)
+{
+    StepEuler(ball, params.Gravity, params.Beta / params.Mass, dt);
+}
+
+template <typename T>
+void StepNoFriction(BallStateT<T>& ball, const PhysicsParamsT<T>& params, T dt)
+{
+    ball.Velocity += dt * params.Gravity;
+    ball.Position += dt * ball.Velocity;
+}
+
+// height and vertical velocity of the exact solution, in double for the root finder
+template <typename T>
+static void VerticalMotion(const BallStateT<T>& ball, double g, double k, double t, double& y, double& vy)
+{
+    double y0 = ball.Position.y, v0 = ball.Velocity.y;
+    if (k == 0.0)
+    {
+        y = y0 + v0 * t + 0.5 * g * t * t;
+        vy = v0 + g * t;
+        return;
+    }
+    // v(t) = vt + (v0 - vt) e^-kt, vt = g / k
+    double vt = g / k;
+    double decay = std::expm1(-k * t); // e^-kt - 1, accurate for small kt
+    y = y0 + vt * t - (v0 - vt) * decay / k;
+    vy = vt + (v0 - vt) * (decay + 1.0);
+}
+
+template <typename T>
+void AdvanceAnalytic(BallStateT<T>& ball, const Vec3T<T>& gravity, T k, T t)
+{
+    if (k == 0)
+    {
+        ball.Position += t * ball.Velocity + (T(0.5) * t * t) * gravity;
+        ball.Velocity += t * gravity;
+        return;
+    }
+    Vec3T<T> terminal = (1 / k) * gravity;
+    T decay = std::expm1(-k * t);
+    ball.Position += t * terminal - (decay / k) * (ball.Velocity - terminal);
+    ball.Velocity = terminal + (decay + 1) * (ball.Velocity - terminal);
+}
+
+template <typename T>
+T SolveImpactTime(const BallStateT<T>& ball, const Vec3T<T>& gravity, T k, T height, T dt)
+{
+    double y, vy;
+    if (ball.Position.y <= height)
+        return 0;
+    VerticalMotion(ball, gravity.y, k, dt, y, vy);
+    if (y > height)
+        return dt;
+
+    // safeguarded Newton: the bracket [lo, hi] always holds the crossing
+    double lo = 0.0, hi = dt;
+    double t = dt * (ball.Position.y - height) / (ball.Position.y - y);
+    for (int i = 0; i < 32; i++)
+    {
+        VerticalMotion(ball, gravity.y, k, t, y, vy);
+        double f = y - height;
+        if (f > 0.0)
+            lo = t;
+        else
+            hi = t;
+        if (std::fabs(f) < 1e-7 || hi - lo < 1e-12)
+            break;
+        double next = vy != 0.0 ? t - f / vy : lo;
+        t = next > lo && next < hi ? next : 0.5 * (lo + hi);
+    }
+    return (T)hi;
+}
+
+// resolves a contact in which the ball pressed into the ground with speed normalSpeed
+template <typename T>
+static void ResolveGroundContact(BallStateT<T>& ball, const GroundPlaneT<T>& ground, T normalSpeed, T rebound)
+{
+    // Coulomb friction: the tangential impulse is bounded by the normal impulse
+    T tangential = std::sqrt(ball.Velocity.x * ball.Velocity.x + ball.Velocity.z * ball.Velocity.z);
+    T reduction = ground.Friction * (normalSpeed + rebound);
+    T scale = tangential > reduction ? (tangential - reduction) / tangential : 0;
+    ball.Velocity = Vec3T<T>(ball.Velocity.x * scale, rebound, ball.Velocity.z * scale);
+
+    if (rebound == 0 && tangential * scale < ground.RestSpeed)
+    {
+        ball.Velocity = Vec3T<T>();
+        ball.Resting = true;
+    }
+}
+
+template <typename T>
+bool StepWithGround(BallStateT<T>& ball, const Vec3T<T>& gravity, T k, T radius, const GroundPlaneT<T>& ground, T dt)
+{
+    if (ball.Resting)
+        return false;
+
+    const T contact = ground.Height + radius;
+    BallStateT<T> start = ball;
+    StepEuler(ball, gravity, k, dt);
+    if (ball.Position.y > contact)
+        return true;
+
+    // crossed the ground during the step: rewind to the exact impact and bounce there
+    T t = SolveImpactTime(start, gravity, k, contact, dt);
+    ball = start;
+    AdvanceAnalytic(ball, gravity, k, t);
+    ball.Position.y = contact;
+    if (ball.Velocity.y < 0)
+    {
+        T normalSpeed = -ball.Velocity.y;
+        T rebound = ground.Restitution * normalSpeed;
+        ResolveGroundContact(ball, ground, normalSpeed, rebound < ground.RestSpeed ? T(0) : rebound);
+    }
+
+    // rest of the step; a ball in contact is held on the ground and slides with friction
+    if (!ball.Resting && t < dt)
+    {
+        StepEuler(ball, gravity, k, dt - t);
+        if (ball.Position.y < contact)
+        {
+            ball.Position.y = contact;
+            if (ball.Velocity.y < 0)
+                ResolveGroundContact(ball, ground, -ball.Velocity.y, T(0));
+        }
+    }
+    return true;
+}
+
+template <typename T>
+bool StepDrag(BallStateT<T>& ball, const PhysicsParamsT<T>& params, const GroundPlaneT<T>& ground, T dt)
+{
+    return StepWithGround(ball, params.Gravity, params.Beta / params.Mass, params.Radius, ground, dt);
+}
+
+template <typename T>
+bool StepNoFriction(BallStateT<T>& ball, const PhysicsParamsT<T>& params, const GroundPlaneT<T>& ground, T dt)
+{
+    return StepWithGround(ball, params.Gravity, T(0), params.Radius, ground, dt);
+}
+
+#define INSTANTIATE_PHYSICS(T) \
+    template void StepDrag<T>(BallStateT<T>&, const PhysicsParamsT<T>&, T); \
+    template void StepNoFriction<T>(BallStateT<T>&, const PhysicsParamsT<T>&, T); \
+    template bool StepDrag<T>(BallStateT<T>&, const PhysicsParamsT<T>&, const GroundPlaneT<T>&, T); \
+    template bool StepNoFriction<T>(BallStateT<T>&, const PhysicsParamsT<T>&, const GroundPlaneT<T>&, T); \
+    template bool StepWithGround<T>(BallStateT<T>&, const Vec3T<T>&, T, T, const GroundPlaneT<T>&, T); \
+    template void AdvanceAnalytic<T>(BallStateT<T>&, const Vec3T<T>&, T, T); \
+    template T SolveImpactTime<T>(const BallStateT<T>&, const Vec3T<T>&, T, T, T);
+
+INSTANTIATE_PHYSICS(float)
+INSTANTIATE_PHYSICS(double)
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "sim/Vec3.h"
+
+/* The physics is templated on the scalar type: float is what the
+   renderer consumes, double keeps centimetre accuracy over long
+   flights. Both are instantiated in Physics.cpp. */
+template <typename T>
+struct PhysicsParamsT
+{
+    Vec3T<T> Gravity = Vec3T<T>(0, -5, 0);
+    T Beta = T(0.5); // linear drag coefficient
+    T Mass = 1;
+    T Radius = T(0.7); // matches the drawn sphere
+};
+
+/* Horizontal floor the balls bounce on. */
+template <typename T>
+struct GroundPlaneT
+{
+    T Height = -50;          // matches floor_coords in Application.cpp
+    T Restitution = T(0.6);  // normal speed kept by a bounce
+    T Friction = T(0.1);     // Coulomb coefficient, tangential impulse <= Friction * normal impulse
+    T RestSpeed = T(0.05);   // below this a bounce becomes contact, and sliding stops
+};
+
+template <typename T>
+struct BallStateT
+{
+    Vec3T<T> Position;
+    Vec3T<T> Velocity;
+    bool Resting = false; // settled on the ground; steps leave it alone
+};
+
+typedef PhysicsParamsT<float> PhysicsParams;
+typedef GroundPlaneT<float> GroundPlane;
+typedef BallStateT<float> BallState;
+typedef PhysicsParamsT<double> PhysicsParamsD;
+typedef GroundPlaneT<double> GroundPlaneD;
+typedef BallStateT<double> BallStateD;
+
+// semi-implicit Euler step with gravity and linear drag -k * velocity, k = beta / mass
+template <typename T> void StepDrag(BallStateT<T>& ball, const PhysicsParamsT<T>& params, T dt);
+// same step with gravity only
+template <typename T> void StepNoFriction(BallStateT<T>& ball, const PhysicsParamsT<T>& params, T dt);
+
+// the steps above plus collision with the ground; return false once the ball rests (nothing moved)
+template <typename T> bool StepDrag(BallStateT<T>& ball, const PhysicsParamsT<T>& params, const GroundPlaneT<T>& ground, T dt);
+template <typename T> bool StepNoFriction(BallStateT<T>& ball, const PhysicsParamsT<T>& params, const GroundPlaneT<T>& ground, T dt);
+
+// semi-implicit Euler under gravity and linear drag k for a sphere of the given radius, with ground collision;
+// the building block of the overloads above (k = 0 and gravity = total acceleration for arbitrary constant forces)
+template <typename T> bool StepWithGround(BallStateT<T>& ball, const Vec3T<T>& gravity, T k, T radius, const GroundPlaneT<T>& ground, T dt);
+
+// exact motion under gravity and linear drag k over time t
+template <typename T> void AdvanceAnalytic(BallStateT<T>& ball, const Vec3T<T>& gravity, T k, T t);
+// first time in [0, dt] at which the exact motion reaches the given height from above; dt if it does not
+template <typename T> T SolveImpactTime(const BallStateT<T>& ball, const Vec3T<T>& gravity, T k, T height, T dt);
@@ -0,0 +1,26 @@
+#include "sim/Simulation.h"
+
+template <typename T>
+void InitSimulation(SimulationT<T>& sim, const Vec3T<T>& position, const Vec3T<T>& velocity)
+{
+    sim.Ball.Position = position;
+    sim.Ball.Velocity = velocity;
+    sim.BallNoFriction = sim.Ball;
+    sim.Path.Clear();
+    sim.PathNoFriction.Clear();
+}
+
+template <typename T>
+void StepSimulation(SimulationT<T>& sim, T dt)
+{
+    // a resting ball adds nothing, so settled runs stop growing
+    if (StepDrag(sim.Ball, sim.Params, sim.Ground, dt))
+        sim.Path.Append(Vec3Cast<double>(sim.Ball.Position));
+    if (StepNoFriction(sim.BallNoFriction, sim.Params, sim.Ground, dt))
+        sim.PathNoFriction.Append(Vec3Cast<double>(sim.BallNoFriction.Position));
+}
+
+template void InitSimulation<float>(Simulation&, const Vec3&, const Vec3&);
+template void InitSimulation<double>(SimulationD&, const Vec3D&, const Vec3D&);
+template void StepSimulation<float>(Simulation&, float);
+template void StepSimulation<double>(SimulationD&, double);
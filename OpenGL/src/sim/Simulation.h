@@ -0,0 +1,26 @@
+#pragma once
+
+#include "sim/Physics.h"
+#include "sim/Trajectory.h"
+
+/* The demo scene: one ball with drag and one without ("nf" = no friction),
+   launched from the same point, each recording its trajectory until it
+   comes to rest on the ground. Trajectories hold float offsets from
+   their chunk origins, so a double simulation ("mixed" precision)
+   integrates in double but hands the renderer floats that stay precise. */
+template <typename T>
+struct SimulationT
+{
+    PhysicsParamsT<T> Params;
+    GroundPlaneT<T> Ground;
+    BallStateT<T> Ball;
+    BallStateT<T> BallNoFriction;
+    Trajectory Path;
+    Trajectory PathNoFriction;
+};
+
+typedef SimulationT<float> Simulation;
+typedef SimulationT<double> SimulationD;
+
+template <typename T> void InitSimulation(SimulationT<T>& sim, const Vec3T<T>& position, const Vec3T<T>& velocity);
+template <typename T> void StepSimulation(SimulationT<T>& sim, T dt);
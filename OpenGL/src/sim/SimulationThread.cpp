@@ -0,0 +1,95 @@
+#include "sim/SimulationThread.h"
+
+#include <chrono>
+
+// steps run back to back when the thread falls behind; beyond this it drops time instead
+static const unsigned int MAX_CATCH_UP_STEPS = 1000;
+
+SimulationThread::SimulationThread(const Vec3D& position, const Vec3D& velocity, double dt)
+    : m_Dt(dt), m_Steps(0), m_RecordHashes(false), m_Stopping(false)
+{
+    InitSimulation(m_Sim, position, velocity);
+    Publish();
+    m_Snapshots.Update();
+}
+
+SimulationThread::~SimulationThread()
+{
+    Stop();
+}
+
+void SimulationThread::Start()
+{
+    if (m_Thread.joinable())
+        return;
+    m_Stopping = false;
+    m_Thread = std::thread(&SimulationThread::ThreadLoop, this);
+}
+
+void SimulationThread::Stop()
+{
+    m_Stopping = true;
+    if (m_Thread.joinable())
+        m_Thread.join();
+}
+
+void SimulationThread::Step()
+{
+    Advance();
+    Publish();
+}
+
+void SimulationThread::Advance()
+{
+    StepSimulation(m_Sim, m_Dt);
+    m_Steps++;
+    if (m_RecordHashes)
+        m_Hashes.Record(m_Steps, HashSimulation(m_Sim));
+}
+
+const SimulationSnapshot& SimulationThread::Latest()
+{
+    m_Snapshots.Update();
+    return m_Snapshots.ReadBuffer();
+}
+
+void SimulationThread::Publish()
+{
+    SimulationSnapshot& snapshot = m_Snapshots.WriteBuffer();
+    snapshot.Time = m_Steps * m_Dt;
+    snapshot.Steps = m_Steps;
+    snapshot.Ball = m_Sim.Ball.Position;
+    snapshot.BallNoFriction = m_Sim.BallNoFriction.Position;
+    snapshot.Path = m_Sim.Path.Data();
+    snapshot.PathOrigins = m_Sim.Path.Origins();
+    snapshot.PathCount = m_Sim.Path.Count();
+    snapshot.PathNoFriction = m_Sim.PathNoFriction.Data();
+    snapshot.PathNoFrictionOrigins = m_Sim.PathNoFriction.Origins();
+    snapshot.PathNoFrictionCount = m_Sim.PathNoFriction.Count();
+    m_Snapshots.Publish();
+}
+
+void SimulationThread::ThreadLoop()
+{
+    typedef std::chrono::steady_clock Clock;
+    const std::chrono::duration<double> dt(m_Dt);
+    Clock::time_point origin = Clock::now() - std::chrono::duration_cast<Clock::duration>(dt * (double)m_Steps);
+
+    while (!m_Stopping)
+    {
+        // catch up to wall-clock time, then publish once for the whole batch
+        unsigned long long due = (unsigned long long)((Clock::now() - origin) / dt);
+        if (due > m_Steps + MAX_CATCH_UP_STEPS)
+        {
+            origin += std::chrono::duration_cast<Clock::duration>(dt * (double)(due - m_Steps - MAX_CATCH_UP_STEPS));
+            due = m_Steps + MAX_CATCH_UP_STEPS;
+        }
+        if (due > m_Steps)
+        {
+            while (m_Steps < due)
+                Advance();
+            Publish();
+        }
+        std::this_thread::sleep_until(origin + std::chrono::duration_cast<Clock::duration>(dt * (double)(m_Steps + 1)));
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "sim/Simulation.h"
+#include "sim/StateHash.h"
+#include "sim/TripleBuffer.h"
+
+/* State the renderer needs from one simulation step. Trajectories are
+   shared, not copied: points below PathCount are never written again,
+   so the reader uploads just the range appended since its last upload.
+   Ball positions are absolute; the renderer narrows them to float only
+   after subtracting the camera position (see Trajectory for the points). */
+struct SimulationSnapshot
+{
+    double Time = 0.0; // simulated seconds
+    unsigned long long Steps = 0;
+    Vec3D Ball;
+    Vec3D BallNoFriction;
+    const float* Path = nullptr;
+    const Vec3D* PathOrigins = nullptr;
+    unsigned int PathCount = 0;
+    const float* PathNoFriction = nullptr;
+    const Vec3D* PathNoFrictionOrigins = nullptr;
+    unsigned int PathNoFrictionCount = 0;
+};
+
+/* Runs the demo scene with a fixed timestep, either on its own thread
+   in real time (Start) or one step per call (Step, for deterministic
+   benchmark runs). Snapshots reach the render thread through a triple
+   buffer, so a vsync-blocked frame never stalls the physics and a slow
+   step never delays a frame. The scene integrates in double and
+   publishes floats (mixed precision). */
+class SimulationThread
+{
+public:
+    SimulationThread(const Vec3D& position, const Vec3D& velocity, double dt);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    void Start();
+    void Stop();
+    // advances one step and publishes it; only while the thread is not running
+    void Step();
+
+    // hash the state after every step (call before Start); the log is complete once stopped
+    void RecordStateHashes(bool record) { m_RecordHashes = record; }
+    const StateLog& Hashes() const { return m_Hashes; }
+
+    // render thread: newest published snapshot
+    const SimulationSnapshot& Latest();
+
+private:
+    void ThreadLoop();
+    void Advance();
+    void Publish();
+
+    SimulationD m_Sim;
+    double m_Dt;
+    unsigned long long m_Steps;
+    bool m_RecordHashes;
+    StateLog m_Hashes;
+
+    TripleBuffer<SimulationSnapshot> m_Snapshots;
+    std::thread m_Thread;
+    std::atomic<bool> m_Stopping;
+};
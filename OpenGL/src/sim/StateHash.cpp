@@ -0,0 +1,88 @@
+#include "sim/StateHash.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+#include "common/Hash.h"
+
+template <typename T>
+static uint64_t HashBallStateT(const BallStateT<T>& ball, uint64_t hash)
+{
+    const T values[6] = { ball.Position.x, ball.Position.y, ball.Position.z, ball.Velocity.x, ball.Velocity.y, ball.Velocity.z };
+    hash = HashBytes(values, sizeof(values), hash);
+    unsigned char resting = ball.Resting ? 1 : 0;
+    return HashBytes(&resting, 1, hash);
+}
+
+uint64_t HashBallState(const BallState& ball, uint64_t hash)
+{
+    return HashBallStateT(ball, hash);
+}
+
+uint64_t HashBallState(const BallStateD& ball, uint64_t hash)
+{
+    return HashBallStateT(ball, hash);
+}
+
+uint64_t HashSimulation(const Simulation& sim)
+{
+    uint64_t hash = HashBallState(sim.Ball);
+    return HashBallState(sim.BallNoFriction, hash);
+}
+
+uint64_t HashSimulation(const SimulationD& sim)
+{
+    uint64_t hash = HashBallState(sim.Ball);
+    return HashBallState(sim.BallNoFriction, hash);
+}
+
+uint64_t HashBallSystem(const BallSystem& balls)
+{
+    const size_t count = balls.Size();
+    uint64_t hash = HashBytes(&count, sizeof(count));
+    // array by array: a fixed order that does not depend on how the step was computed
+    const std::vector<float>* arrays[] = { &balls.PosX, &balls.PosY, &balls.PosZ, &balls.VelX, &balls.VelY, &balls.VelZ };
+    for (const std::vector<float>* values : arrays)
+        hash = HashBytes(values->data(), values->size() * sizeof(float), hash);
+    return HashBytes(balls.Resting.data(), balls.Resting.size(), hash);
+}
+
+void StateLog::Record(unsigned long long step, uint64_t hash)
+{
+    m_Entries.push_back({ step, hash });
+}
+
+bool StateLog::Write(const std::string& filepath) const
+{
+    FILE* file = std::fopen(filepath.c_str(), "w");
+    if (!file)
+        return false;
+    for (const Entry& entry : m_Entries)
+        std::fprintf(file, "%llu %016" PRIx64 "\n", entry.Step, entry.Hash);
+    return std::fclose(file) == 0;
+}
+
+bool StateLog::Read(const std::string& filepath)
+{
+    FILE* file = std::fopen(filepath.c_str(), "r");
+    if (!file)
+        return false;
+    m_Entries.clear();
+    Entry entry;
+    while (std::fscanf(file, "%llu %" SCNx64, &entry.Step, &entry.Hash) == 2)
+        m_Entries.push_back(entry);
+    std::fclose(file);
+    return true;
+}
+
+long long StateLog::FirstMismatch(const StateLog& other) const
+{
+    size_t count = std::min(m_Entries.size(), other.m_Entries.size());
+    for (size_t i = 0; i < count; i++)
+    {
+        if (m_Entries[i].Step != other.m_Entries[i].Step || m_Entries[i].Hash != other.m_Entries[i].Hash)
+            return (long long)i;
+    }
+    return -1;
+}
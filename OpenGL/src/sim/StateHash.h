@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sim/BallSystem.h"
+#include "sim/Simulation.h"
+
+/* Hashes of the exact bit patterns of the simulation state. Two runs
+   are bit-identical up to a step exactly when their hashes agree, which
+   is how the deterministic mode is checked and replays are verified. */
+uint64_t HashBallState(const BallState& ball, uint64_t hash = 14695981039346656037ull);
+uint64_t HashBallState(const BallStateD& ball, uint64_t hash = 14695981039346656037ull);
+uint64_t HashSimulation(const Simulation& sim);
+uint64_t HashSimulation(const SimulationD& sim);
+uint64_t HashBallSystem(const BallSystem& balls);
+
+/* Per-step state hashes, saved as one "step hash" text line per step. */
+class StateLog
+{
+public:
+    void Record(unsigned long long step, uint64_t hash);
+    void Clear() { m_Entries.clear(); }
+    size_t Size() const { return m_Entries.size(); }
+
+    bool Write(const std::string& filepath) const;
+    bool Read(const std::string& filepath);
+
+    // index of the first entry that differs from other over their common length, or -1 if none does
+    long long FirstMismatch(const StateLog& other) const;
+    unsigned long long StepAt(size_t index) const { return m_Entries[index].Step; }
+
+private:
+    struct Entry
+    {
+        unsigned long long Step;
+        uint64_t Hash;
+    };
+    std::vector<Entry> m_Entries;
+};
@@ -0,0 +1,170 @@
+#include "sim/Sweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include "common/Hash.h"
+
+// scenarios handed to a worker at a time: large enough to amortize the atomic, small enough to balance
+static const size_t SWEEP_BATCH = 64;
+
+SweepResult RunScenario(const SweepScenario& scenario, const SweepSettings& settings)
+{
+    SweepResult result;
+    BallState ball;
+    ball.Position = scenario.Position;
+    ball.Velocity = scenario.Velocity;
+    result.Apex = ball.Position.y;
+    const float k = scenario.Params.Beta / scenario.Params.Mass;
+
+    const unsigned int maxSteps = (unsigned int)(settings.MaxTime / settings.Dt);
+    unsigned int step = 0;
+    while (step < maxSteps)
+    {
+        BallState previous = ball;
+        StepDrag(ball, scenario.Params, settings.Dt);
+        step++;
+        result.Apex = std::max(result.Apex, ball.Position.y);
+
+        if (ball.Position.y <= settings.GroundY && previous.Position.y > settings.GroundY)
+        {
+            // exact crossing within the step
+            float t = SolveImpactTime(previous, scenario.Params.Gravity, k, settings.GroundY, settings.Dt);
+            AdvanceAnalytic(previous, scenario.Params.Gravity, k, t);
+            result.ImpactVelocity = previous.Velocity;
+            result.FlightTime = (step - 1) * settings.Dt + t;
+            float dx = previous.Position.x - scenario.Position.x;
+            float dz = previous.Position.z - scenario.Position.z;
+            result.Range = std::sqrt(dx * dx + dz * dz);
+            result.Landed = true;
+            return result;
+        }
+    }
+
+    result.ImpactVelocity = ball.Velocity;
+    result.FlightTime = step * settings.Dt;
+    float dx = ball.Position.x - scenario.Position.x;
+    float dz = ball.Position.z - scenario.Position.z;
+    result.Range = std::sqrt(dx * dx + dz * dz);
+    return result;
+}
+
+unsigned int RunSweep(const std::vector<SweepScenario>& scenarios, std::vector<SweepResult>& results, const SweepSettings& settings)
+{
+    results.assign(scenarios.size(), SweepResult());
+
+    unsigned int threadCount = settings.ThreadCount;
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = (unsigned int)std::min<size_t>(threadCount, std::max<size_t>(1, (scenarios.size() + SWEEP_BATCH - 1) / SWEEP_BATCH));
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (;;)
+        {
+            size_t begin = next.fetch_add(SWEEP_BATCH);
+            if (begin >= scenarios.size())
+                return;
+            size_t end = std::min(begin + SWEEP_BATCH, scenarios.size());
+            for (size_t i = begin; i < end; i++)
+                results[i] = RunScenario(scenarios[i], settings);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount; i++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+    return threadCount;
+}
+
+uint64_t HashSweepResults(const std::vector<SweepResult>& results)
+{
+    uint64_t hash = HashBytes(nullptr, 0);
+    for (const SweepResult& r : results)
+    {
+        const float values[7] = { r.Range, r.Apex, r.FlightTime, r.ImpactVelocity.x, r.ImpactVelocity.y, r.ImpactVelocity.z, r.Landed ? 1.0f : 0.0f };
+        hash = HashBytes(values, sizeof(values), hash);
+    }
+    return hash;
+}
+
+bool WriteSweepCsv(const std::string& filepath, const std::vector<SweepScenario>& scenarios, const std::vector<SweepResult>& results)
+{
+    FILE* file = std::fopen(filepath.c_str(), "w");
+    if (!file)
+        return false;
+
+    std::fprintf(file, "px,py,pz,vx,vy,vz,beta,mass,gx,gy,gz,range,apex,flight_time,impact_vx,impact_vy,impact_vz,impact_speed,landed\n");
+    for (size_t i = 0; i < scenarios.size(); i++)
+    {
+        const SweepScenario& s = scenarios[i];
+        const SweepResult& r = results[i];
+        std::fprintf(file, "%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%d\n",
+            s.Position.x, s.Position.y, s.Position.z, s.Velocity.x, s.Velocity.y, s.Velocity.z,
+            s.Params.Beta, s.Params.Mass, s.Params.Gravity.x, s.Params.Gravity.y, s.Params.Gravity.z,
+            r.Range, r.Apex, r.FlightTime, r.ImpactVelocity.x, r.ImpactVelocity.y, r.ImpactVelocity.z,
+            Length(r.ImpactVelocity), r.Landed ? 1 : 0);
+    }
+    return std::fclose(file) == 0;
+}
+
+namespace
+{
+    const uint32_t SWEEP_MAGIC = 0x50575342; // "BSWP"
+    const uint32_t SWEEP_VERSION = 1;
+
+    struct SweepHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t Count;
+    };
+
+    // one record per scenario, little-endian floats as in memory
+    struct SweepRecord
+    {
+        float Position[3];
+        float Velocity[3];
+        float Beta;
+        float Mass;
+        float Gravity[3];
+        float Range;
+        float Apex;
+        float FlightTime;
+        float ImpactVelocity[3];
+        uint32_t Landed;
+    };
+}
+
+bool WriteSweepBinary(const std::string& filepath, const std::vector<SweepScenario>& scenarios, const std::vector<SweepResult>& results)
+{
+    std::ofstream out(filepath, std::ios::binary);
+    if (!out)
+        return false;
+
+    SweepHeader header = { SWEEP_MAGIC, SWEEP_VERSION, scenarios.size() };
+    out.write((const char*)&header, sizeof(header));
+
+    std::vector<SweepRecord> records(scenarios.size());
+    for (size_t i = 0; i < scenarios.size(); i++)
+    {
+        const SweepScenario& s = scenarios[i];
+        const SweepResult& r = results[i];
+        SweepRecord& record = records[i];
+        record = { { s.Position.x, s.Position.y, s.Position.z }, { s.Velocity.x, s.Velocity.y, s.Velocity.z },
+                   s.Params.Beta, s.Params.Mass, { s.Params.Gravity.x, s.Params.Gravity.y, s.Params.Gravity.z },
+                   r.Range, r.Apex, r.FlightTime, { r.ImpactVelocity.x, r.ImpactVelocity.y, r.ImpactVelocity.z },
+                   r.Landed ? 1u : 0u };
+    }
+    out.write((const char*)records.data(), (std::streamsize)(records.size() * sizeof(SweepRecord)));
+    return (bool)out;
+}
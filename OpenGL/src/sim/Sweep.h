@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sim/Physics.h"
+
+/* Batch evaluation of many launch scenarios without rendering: each
+   ball is integrated with StepDrag until its centre reaches the ground
+   height (the impact time is solved exactly within the last step), and
+   only summary numbers are kept. */
+struct SweepScenario
+{
+    Vec3 Position = Vec3(0.0f, 10.0f, 0.0f);
+    Vec3 Velocity = Vec3(5.0f, 0.0f, 0.0f);
+    PhysicsParams Params;
+};
+
+struct SweepResult
+{
+    float Range = 0.0f;      // horizontal distance from launch to impact
+    float Apex = 0.0f;       // highest y reached
+    float FlightTime = 0.0f; // seconds until impact (or MaxTime)
+    Vec3 ImpactVelocity;
+    bool Landed = false;     // false if MaxTime ran out first
+};
+
+struct SweepSettings
+{
+    float Dt = 1.0f / 240.0f;
+    float GroundY = -50.0f; // the floor drawn by the demo
+    float MaxTime = 600.0f;
+    unsigned int ThreadCount = 0; // 0 = hardware concurrency
+};
+
+SweepResult RunScenario(const SweepScenario& scenario, const SweepSettings& settings);
+// results[i] belongs to scenarios[i]; scenarios are split across worker threads.
+// Returns the number of threads used, ThreadCount clamped to the number of batches.
+unsigned int RunSweep(const std::vector<SweepScenario>& scenarios, std::vector<SweepResult>& results, const SweepSettings& settings);
+
+// bit-exact fingerprint of all results, equal for any thread count
+uint64_t HashSweepResults(const std::vector<SweepResult>& results);
+
+bool WriteSweepCsv(const std::string& filepath, const std::vector<SweepScenario>& scenarios, const std::vector<SweepResult>& results);
+bool WriteSweepBinary(const std::string& filepath, const std::vector<SweepScenario>& scenarios, const std::vector<SweepResult>& results);
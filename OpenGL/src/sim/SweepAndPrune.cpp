@@ -0,0 +1,124 @@
+#include "sim/SweepAndPrune.h"
+
+#include <algorithm>
+#include <numeric>
+
+// steps between re-evaluations of the sweep axis
+static const unsigned int AXIS_CHECK_INTERVAL = 64;
+
+static const std::vector<float>& AxisPositions(const BallSystem& balls, int axis)
+{
+    return axis == 0 ? balls.PosX : axis == 1 ? balls.PosY : balls.PosZ;
+}
+
+// axis with the largest spread of centres
+static int DominantAxis(const BallSystem& balls)
+{
+    const size_t count = balls.Size();
+    double sum[3] = { 0.0, 0.0, 0.0 }, sum2[3] = { 0.0, 0.0, 0.0 };
+    for (size_t i = 0; i < count; i++)
+    {
+        const float p[3] = { balls.PosX[i], balls.PosY[i], balls.PosZ[i] };
+        for (int axis = 0; axis < 3; axis++)
+        {
+            sum[axis] += p[axis];
+            sum2[axis] += (double)p[axis] * p[axis];
+        }
+    }
+    int best = 0;
+    double bestVariance = -1.0;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        double variance = sum2[axis] - sum[axis] * sum[axis] / std::max<size_t>(count, 1);
+        if (variance > bestVariance)
+        {
+            bestVariance = variance;
+            best = axis;
+        }
+    }
+    return best;
+}
+
+void SweepAndPrune::UpdateOrder(const BallSystem& balls)
+{
+    const size_t count = balls.Size();
+    // the spread is re-checked now and then; a different axis or ball set makes the old order useless
+    int axis = m_Axis;
+    if (m_Order.size() != count || m_Axis < 0 || ++m_Calls % AXIS_CHECK_INTERVAL == 0)
+        axis = DominantAxis(balls);
+    const std::vector<float>& position = AxisPositions(balls, axis);
+
+    m_Min.resize(count);
+    if (axis != m_Axis || m_Order.size() != count)
+    {
+        m_Axis = axis;
+        m_Order.resize(count);
+        std::iota(m_Order.begin(), m_Order.end(), 0u);
+        std::sort(m_Order.begin(), m_Order.end(), [&](uint32_t a, uint32_t b) { return position[a] - balls.Radius[a] < position[b] - balls.Radius[b]; });
+        for (size_t slot = 0; slot < count; slot++)
+            m_Min[slot] = position[m_Order[slot]] - balls.Radius[m_Order[slot]];
+        m_Swaps = count;
+        return;
+    }
+
+    for (size_t slot = 0; slot < count; slot++)
+        m_Min[slot] = position[m_Order[slot]] - balls.Radius[m_Order[slot]];
+
+    // insertion sort on the previous order: nearly sorted, so few moves
+    m_Swaps = 0;
+    for (size_t slot = 1; slot < count; slot++)
+    {
+        float key = m_Min[slot];
+        if (!(key < m_Min[slot - 1]))
+            continue;
+        uint32_t ball = m_Order[slot];
+        size_t hole = slot;
+        while (hole > 0 && key < m_Min[hole - 1])
+        {
+            m_Min[hole] = m_Min[hole - 1];
+            m_Order[hole] = m_Order[hole - 1];
+            hole--;
+            m_Swaps++;
+        }
+        m_Min[hole] = key;
+        m_Order[hole] = ball;
+    }
+}
+
+void SweepAndPrune::FindPairs(const BallSystem& balls, std::vector<BallPair>& pairs)
+{
+    pairs.clear();
+    if (balls.Size() == 0)
+        return;
+    UpdateOrder(balls);
+
+    // gather into sweep order so the inner loop reads contiguous memory
+    const size_t count = balls.Size();
+    m_Max.resize(count);
+    m_X.resize(count); m_Y.resize(count); m_Z.resize(count); m_R.resize(count);
+    const std::vector<float>& position = AxisPositions(balls, m_Axis);
+    for (size_t slot = 0; slot < count; slot++)
+    {
+        uint32_t ball = m_Order[slot];
+        m_X[slot] = balls.PosX[ball];
+        m_Y[slot] = balls.PosY[ball];
+        m_Z[slot] = balls.PosZ[ball];
+        m_R[slot] = balls.Radius[ball];
+        m_Max[slot] = position[ball] + balls.Radius[ball];
+    }
+
+    for (size_t slot = 0; slot < count; slot++)
+    {
+        const float x = m_X[slot], y = m_Y[slot], z = m_Z[slot], r = m_R[slot], end = m_Max[slot];
+        for (size_t other = slot + 1; other < count && m_Min[other] < end; other++)
+        {
+            float dx = m_X[other] - x, dy = m_Y[other] - y, dz = m_Z[other] - z;
+            float radii = r + m_R[other];
+            if (dx * dx + dy * dy + dz * dz < radii * radii)
+            {
+                uint32_t a = m_Order[slot], b = m_Order[other];
+                pairs.push_back(a < b ? BallPair{ a, b } : BallPair{ b, a });
+            }
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sim/BallSystem.h"
+
+/* Sort-and-sweep broad phase along the axis the balls are spread along
+   most. The order is kept between steps and repaired with an insertion
+   sort, which is close to linear because balls move little per step.
+   Needs no memory per unit of space, so it suits long, thin scenes
+   where a grid would be mostly empty. */
+class SweepAndPrune : public BroadPhase
+{
+public:
+    void FindPairs(const BallSystem& balls, std::vector<BallPair>& pairs) override;
+
+    int Axis() const { return m_Axis; }
+    // element moves done by the last insertion sort (0 when nothing changed order)
+    size_t LastSwaps() const { return m_Swaps; }
+
+private:
+    void UpdateOrder(const BallSystem& balls);
+
+    int m_Axis = -1;
+    unsigned int m_Calls = 0;
+    size_t m_Swaps = 0;
+    std::vector<uint32_t> m_Order;      // ball indices by interval start on m_Axis
+    std::vector<float> m_Min, m_Max;    // per sorted slot: interval on m_Axis
+    std::vector<float> m_X, m_Y, m_Z, m_R; // per sorted slot: copies in sweep order
+};
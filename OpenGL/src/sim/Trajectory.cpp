@@ -0,0 +1,42 @@
+#include "sim/Trajectory.h"
+
+Trajectory::Trajectory(unsigned int maxPoints)
+    : m_Count(0), m_MaxPoints(maxPoints)
+{
+    m_Coords.reserve((size_t)maxPoints * 3);
+    m_Origins.reserve(ChunkCount(maxPoints));
+}
+
+bool Trajectory::Append(const Vec3D& point)
+{
+    // a new chunk after the first repeats the joint point, at offset zero from its origin
+    bool newChunk = m_Count % CHUNK_POINTS == 0;
+    bool joint = newChunk && m_Count > 0;
+    if (m_Count + (joint ? 2 : 1) > m_MaxPoints)
+        return false;
+
+    if (newChunk)
+    {
+        m_Origins.push_back(joint ? m_Last : point);
+        if (joint)
+            Push(Vec3D());
+    }
+    Push(point - m_Origins.back());
+    m_Last = point;
+    return true;
+}
+
+void Trajectory::Push(const Vec3D& offset)
+{
+    m_Coords.push_back((float)offset.x);
+    m_Coords.push_back((float)offset.y);
+    m_Coords.push_back((float)offset.z);
+    m_Count++;
+}
+
+void Trajectory::Clear()
+{
+    m_Coords.clear();
+    m_Origins.clear();
+    m_Count = 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "sim/Vec3.h"
+
+/* Recorded ball path as tightly packed xyz floats, ready for a GL_LINE_STRIP upload.
+   Points are grouped in chunks of CHUNK_POINTS; each chunk stores float offsets
+   from its own double origin and begins with that origin (the previous chunk's
+   last point), so distant flights keep float precision, the chunks still join
+   into one strip, and recorded points never need rebasing or re-upload.
+   Storage for maxPoints is reserved up front and never moves, so another
+   thread may read points and origins below a Count() it was handed while appending continues. */
+class Trajectory
+{
+public:
+    static const unsigned int DEFAULT_CAPACITY = 1000000;
+    static const unsigned int CHUNK_POINTS = 65536;
+
+    explicit Trajectory(unsigned int maxPoints = DEFAULT_CAPACITY);
+
+    // returns false once the point budget is exhausted
+    bool Append(const Vec3D& point);
+    void Clear();
+
+    const float* Data() const { return m_Coords.data(); }
+    unsigned int Count() const { return m_Count; }
+    unsigned int Capacity() const { return m_MaxPoints; }
+    size_t SizeInBytes() const { return m_Coords.size() * sizeof(float); }
+
+    // origin of chunk c, which holds points [c * CHUNK_POINTS, (c + 1) * CHUNK_POINTS)
+    const Vec3D* Origins() const { return m_Origins.data(); }
+    static unsigned int ChunkCount(unsigned int count) { return (count + CHUNK_POINTS - 1) / CHUNK_POINTS; }
+
+private:
+    void Push(const Vec3D& offset);
+
+    std::vector<float> m_Coords;
+    std::vector<Vec3D> m_Origins;
+    Vec3D m_Last;
+    unsigned int m_Count;
+    unsigned int m_MaxPoints;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+
+/* Lock-free single-producer/single-consumer handoff of the latest value.
+   The writer fills WriteBuffer() and Publish()es it; the reader calls
+   Update() to take the newest published slot and reads ReadBuffer().
+   Neither side ever waits: intermediate values the reader did not get
+   to are simply overwritten. */
+template<typename T>
+class TripleBuffer
+{
+public:
+    // writer side
+    T& WriteBuffer() { return m_Slots[m_Back].Value; }
+    void Publish()
+    {
+        m_Back = m_Middle.exchange(m_Back | DIRTY, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // reader side; returns true if a newer value was taken
+    bool Update()
+    {
+        if (!(m_Middle.load(std::memory_order_relaxed) & DIRTY))
+            return false;
+        m_Front = m_Middle.exchange(m_Front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T& ReadBuffer() const { return m_Slots[m_Front].Value; }
+
+private:
+    static const unsigned int INDEX = 3;
+    static const unsigned int DIRTY = 4;
+
+    // one cache line per slot and per side, so writer and reader do not false-share
+    struct alignas(64) Slot
+    {
+        T Value;
+    };
+
+    Slot m_Slots[3];
+    alignas(64) std::atomic<unsigned int> m_Middle{ 1 };
+    alignas(64) unsigned int m_Back = 2;  // writer only
+    alignas(64) unsigned int m_Front = 0; // reader only
+};
@@ -0,0 +1,108 @@
+#include "sim/UniformGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+static inline int32_t CellCoord(float v, float invCellSize)
+{
+    return (int32_t)std::floor(v * invCellSize);
+}
+
+static inline uint32_t HashCell(int32_t x, int32_t y, int32_t z, uint32_t mask)
+{
+    return ((uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u) & mask;
+}
+
+inline void UniformGrid::TestPair(uint32_t slot, uint32_t other, float x, float y, float z, float r, std::vector<BallPair>& pairs) const
+{
+    float dx = m_X[other] - x, dy = m_Y[other] - y, dz = m_Z[other] - z;
+    float radii = r + m_R[other];
+    if (dx * dx + dy * dy + dz * dz < radii * radii)
+    {
+        uint32_t a = m_Sorted[slot], b = m_Sorted[other];
+        pairs.push_back(a < b ? BallPair{ a, b } : BallPair{ b, a });
+    }
+}
+
+void UniformGrid::Build(const BallSystem& balls)
+{
+    const size_t count = balls.Size();
+    float cellSize = 2.0f * balls.MaxRadius();
+    m_InvCellSize = cellSize > 0.0f ? 1.0f / cellSize : 1.0f;
+
+    // about one bucket per ball: collisions between occupied cells stay rare and the table stays cache sized
+    uint32_t tableSize = 1;
+    while (tableSize < count)
+        tableSize <<= 1;
+    m_Mask = tableSize - 1;
+
+    m_Cell.resize(count);
+    m_CellStart.assign((size_t)tableSize + 1, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t cell = HashCell(CellCoord(balls.PosX[i], m_InvCellSize), CellCoord(balls.PosY[i], m_InvCellSize), CellCoord(balls.PosZ[i], m_InvCellSize), m_Mask);
+        m_Cell[i] = cell;
+        m_CellStart[cell + 1]++;
+    }
+    for (uint32_t cell = 0; cell < tableSize; cell++)
+        m_CellStart[cell + 1] += m_CellStart[cell];
+
+    // scatter into cell order; the cursor of each cell ends at the next cell's start
+    m_Sorted.resize(count);
+    m_X.resize(count); m_Y.resize(count); m_Z.resize(count); m_R.resize(count);
+    m_CX.resize(count); m_CY.resize(count); m_CZ.resize(count);
+    m_Cursor.assign(m_CellStart.begin(), m_CellStart.end() - 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t slot = m_Cursor[m_Cell[i]]++;
+        m_Sorted[slot] = (uint32_t)i;
+        m_X[slot] = balls.PosX[i];
+        m_Y[slot] = balls.PosY[i];
+        m_Z[slot] = balls.PosZ[i];
+        m_R[slot] = balls.Radius[i];
+        m_CX[slot] = CellCoord(balls.PosX[i], m_InvCellSize);
+        m_CY[slot] = CellCoord(balls.PosY[i], m_InvCellSize);
+        m_CZ[slot] = CellCoord(balls.PosZ[i], m_InvCellSize);
+    }
+}
+
+void UniformGrid::FindPairs(const BallSystem& balls, std::vector<BallPair>& pairs)
+{
+    pairs.clear();
+    Build(balls);
+
+    // the cell itself plus the 13 neighbours "after" it, so each pair of cells is visited once
+    static const int NEIGHBOURS[13][3] = {
+        { 1, 0, 0 }, { -1, 1, 0 }, { 0, 1, 0 }, { 1, 1, 0 },
+        { -1, -1, 1 }, { 0, -1, 1 }, { 1, -1, 1 }, { -1, 0, 1 }, { 0, 0, 1 }, { 1, 0, 1 }, { -1, 1, 1 }, { 0, 1, 1 }, { 1, 1, 1 },
+    };
+
+    const uint32_t count = (uint32_t)m_Sorted.size();
+    for (uint32_t slot = 0; slot < count; slot++)
+    {
+        const float x = m_X[slot], y = m_Y[slot], z = m_Z[slot], r = m_R[slot];
+        const int32_t cx = m_CX[slot], cy = m_CY[slot], cz = m_CZ[slot];
+
+        // later balls of the same cell (a bucket may also hold other cells that hash alike)
+        const uint32_t cellEnd = m_CellStart[m_Cell[m_Sorted[slot]] + 1];
+        for (uint32_t other = slot + 1; other < cellEnd; other++)
+        {
+            if (m_CX[other] != cx || m_CY[other] != cy || m_CZ[other] != cz)
+                continue;
+            TestPair(slot, other, x, y, z, r, pairs);
+        }
+
+        for (const int* offset : NEIGHBOURS)
+        {
+            const int32_t nx = cx + offset[0], ny = cy + offset[1], nz = cz + offset[2];
+            const uint32_t bucket = HashCell(nx, ny, nz, m_Mask);
+            const uint32_t end = m_CellStart[bucket + 1];
+            for (uint32_t other = m_CellStart[bucket]; other < end; other++)
+            {
+                if (m_CX[other] != nx || m_CY[other] != ny || m_CZ[other] != nz)
+                    continue;
+                TestPair(slot, other, x, y, z, r, pairs);
+            }
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sim/BallSystem.h"
+
+/* Broad phase on a hashed uniform grid with cells as wide as the
+   largest ball, so overlapping balls are always in neighbouring cells.
+   Rebuilt every step with a counting sort: balls are bucketed by cell
+   and their positions copied into cell order, so the neighbour scans
+   read contiguous memory. The hash keeps memory proportional to the
+   ball count however far the balls spread. */
+class UniformGrid : public BroadPhase
+{
+public:
+    void FindPairs(const BallSystem& balls, std::vector<BallPair>& pairs) override;
+
+    size_t CellCount() const { return m_CellStart.empty() ? 0 : m_CellStart.size() - 1; }
+
+private:
+    void Build(const BallSystem& balls);
+    void TestPair(uint32_t slot, uint32_t other, float x, float y, float z, float r, std::vector<BallPair>& pairs) const;
+
+    float m_InvCellSize = 1.0f;
+    uint32_t m_Mask = 0;
+    std::vector<uint32_t> m_Cell;      // per ball: hashed cell
+    std::vector<uint32_t> m_CellStart; // per cell: first slot, plus one past the end
+    std::vector<uint32_t> m_Cursor;    // per cell: next free slot while scattering, reused across builds
+    std::vector<uint32_t> m_Sorted;    // per slot: ball index, grouped by cell
+    std::vector<float> m_X, m_Y, m_Z, m_R; // per slot: copies in cell order
+    std::vector<int32_t> m_CX, m_CY, m_CZ; // per slot: unhashed cell, tells apart cells sharing a bucket
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cmath>
+
+/* Minimal 3-component vector for the simulation library.
+   The simulation is kept free of GL and glm so it builds headless;
+   the renderer converts to glm::vec3 at the boundary. */
+template <typename T>
+struct Vec3T
+{
+    T x, y, z;
+
+    Vec3T() : x(0), y(0), z(0) {}
+    Vec3T(T x, T y, T z) : x(x), y(y), z(z) {}
+
+    Vec3T& operator+=(const Vec3T& o) { x += o.x; y += o.y; z += o.z; return *this; }
+    Vec3T& operator-=(const Vec3T& o) { x -= o.x; y -= o.y; z -= o.z; return *this; }
+    Vec3T& operator*=(T s) { x *= s; y *= s; z *= s; return *this; }
+};
+
+template <typename T> inline Vec3T<T> operator+(Vec3T<T> a, const Vec3T<T>& b) { return a += b; }
+template <typename T> inline Vec3T<T> operator-(Vec3T<T> a, const Vec3T<T>& b) { return a -= b; }
+template <typename T> inline Vec3T<T> operator-(const Vec3T<T>& a) { return Vec3T<T>(-a.x, -a.y, -a.z); }
+template <typename T> inline Vec3T<T> operator*(T s, Vec3T<T> a) { return a *= s; }
+template <typename T> inline Vec3T<T> operator*(Vec3T<T> a, T s) { return a *= s; }
+
+template <typename T> inline T Dot(const Vec3T<T>& a, const Vec3T<T>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+template <typename T> inline T Length(const Vec3T<T>& a) { return std::sqrt(Dot(a, a)); }
+
+// converts between precisions, e.g. a double position to the float the renderer uploads
+template <typename To, typename From> inline Vec3T<To> Vec3Cast(const Vec3T<From>& a) { return Vec3T<To>((To)a.x, (To)a.y, (To)a.z); }
+
+typedef Vec3T<float> Vec3;
+typedef Vec3T<double> Vec3D;
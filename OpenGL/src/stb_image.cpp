@@ -1,2 +1,11 @@
+#include "renderer/ImageAllocator.h"
+#include "renderer/PngUnfilter.h"
+
+#define STBI_MALLOC(sz)       ImagePoolMalloc(sz)
+#define STBI_REALLOC(p, newsz) ImagePoolRealloc(p, newsz)
+#define STBI_FREE(p)          ImagePoolFree(p)
+
+#define STBI_PNG_UNFILTER_ROW PngUnfilterRow
+
 #define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
\ No newline at end of file
+#include "stb_image.h"
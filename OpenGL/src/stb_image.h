@@ -4659,6 +4659,13 @@ static int stbi__create_png_image_raw(stbi__png* a, stbi_uc* raw, stbi__uint32 r
         }
 
         // this is a little gross, so that we don't switch per-pixel or per-component
+#ifdef STBI_PNG_UNFILTER_ROW
+        // optional accelerated unfilter for 8-bit rows; returns 0 to fall back to the loops below
+        if (depth == 8 && STBI_PNG_UNFILTER_ROW(filter, cur, prior, raw, x - 1, filter_bytes, output_bytes)) {
+            raw += (x - 1) * filter_bytes;
+            continue;
+        }
+#endif
         if (depth < 8 || img_n == out_n) {
             int nk = (width - 1) * filter_bytes;
 #define STBI__CASE(f) \
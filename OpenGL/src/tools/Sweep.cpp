@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sim/Sweep.h"
+
+/* Parameter sweep: ball_sweep [options]
+   Every axis takes a single value, a list "a,b,c" or a range "from:to:count";
+   the scenarios are the cartesian product of all axes. --list reads
+   scenarios instead, one "px,py,pz,vx,vy,vz,beta,mass,gx,gy,gz" per line.
+   --check compares every landing with the stepping solved in closed form, in
+   double, and the results with a single-threaded rerun bit for bit. */
+static void PrintUsage(const char* program)
+{
+    std::cout << "usage: " << program << " [--px|--py|--pz|--vx|--vy|--vz|--beta|--mass|--gx|--gy|--gz VALUES]\n"
+              << "       [--list FILE] [--out FILE.csv|FILE.bin] [--threads N] [--dt X] [--ground Y] [--max-time T] [--check]" << std::endl;
+}
+
+static bool ParseValues(const char* text, std::vector<float>& values)
+{
+    values.clear();
+    const char* colon = std::strchr(text, ':');
+    if (colon)
+    {
+        char* end = nullptr;
+        float from = std::strtof(text, &end);
+        if (end != colon)
+            return false;
+        float to = std::strtof(colon + 1, &end);
+        if (*end != ':')
+            return false;
+        long count = std::strtol(end + 1, &end, 10);
+        if (*end || count < 1)
+            return false;
+        for (long i = 0; i < count; i++)
+            values.push_back(count == 1 ? from : from + (to - from) * i / (count - 1));
+        return true;
+    }
+
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        char* end = nullptr;
+        values.push_back(std::strtof(item.c_str(), &end));
+        if (item.empty() || *end)
+            return false;
+    }
+    return !values.empty();
+}
+
+static bool ReadScenarioList(const std::string& filepath, std::vector<SweepScenario>& scenarios)
+{
+    std::ifstream in(filepath);
+    if (!in)
+        return false;
+
+    std::string line;
+    unsigned int lineNumber = 0;
+    while (std::getline(in, line))
+    {
+        lineNumber++;
+        if (line.empty() || line[0] == '#' || line.compare(0, 2, "px") == 0)
+            continue;
+        std::vector<float> v;
+        if (!ParseValues(line.c_str(), v) || v.size() != 11)
+        {
+            std::cout << filepath << ":" << lineNumber << ": expected 11 comma separated numbers" << std::endl;
+            return false;
+        }
+        SweepScenario s;
+        s.Position = Vec3(v[0], v[1], v[2]);
+        s.Velocity = Vec3(v[3], v[4], v[5]);
+        s.Params.Beta = v[6];
+        s.Params.Mass = v[7];
+        s.Params.Gravity = Vec3(v[8], v[9], v[10]);
+        scenarios.push_back(s);
+    }
+    return true;
+}
+
+// exact linear-drag motion over t (k = beta / mass) from position p, velocity v
+static double ClosedForm(double p, double v, double g, double k, double t)
+{
+    if (k == 0.0)
+        return p + v * t + 0.5 * g * t * t;
+    return p + g * t / k + (v - g / k) * -std::expm1(-k * t) / k;
+}
+
+/* Sum of n StepDrag steps in closed form, in double. The recurrence
+   v' = (1 - k dt) v + g dt, p' = p + dt v' is geometric in (1 - k dt). */
+static void SteppedState(double& p, double& v, double g, double k, double dt, double n)
+{
+    if (k == 0.0)
+    {
+        p += dt * (n * v + g * dt * n * (n + 1.0) / 2.0);
+        v += n * g * dt;
+        return;
+    }
+    double terminal = g / k, r = 1.0 - k * dt, rn = std::pow(r, n);
+    p += n * dt * terminal + (v - terminal) * r * (1.0 - rn) / k;
+    v = terminal + (v - terminal) * rn;
+}
+
+/* Every landed ball must reach the ground at FlightTime, Range away from its
+   launch: whole steps from SteppedState, then the exact solution within the
+   impact step. Only float rounding separates this from the float run. */
+static bool CheckAgainstClosedForm(const std::vector<SweepScenario>& scenarios, const std::vector<SweepResult>& results, const SweepSettings& settings)
+{
+    size_t checked = 0, mismatches = 0;
+    double worst = 0.0;
+    const double dt = settings.Dt;
+    for (size_t i = 0; i < scenarios.size(); i++)
+    {
+        if (!results[i].Landed)
+            continue;
+        const SweepScenario& s = scenarios[i];
+        const double k = (double)s.Params.Beta / s.Params.Mass, t = results[i].FlightTime;
+        const double steps = std::floor(t / dt), tail = t - steps * dt;
+        double p[3] = { s.Position.x, s.Position.y, s.Position.z };
+        double v[3] = { s.Velocity.x, s.Velocity.y, s.Velocity.z };
+        const double g[3] = { s.Params.Gravity.x, s.Params.Gravity.y, s.Params.Gravity.z };
+        double speed = 0.0, gravity = 0.0;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            speed += v[axis] * v[axis];
+            gravity += g[axis] * g[axis];
+            SteppedState(p[axis], v[axis], g[axis], k, dt, steps);
+            p[axis] = ClosedForm(p[axis], v[axis], g[axis], k, tail);
+        }
+        double dx = p[0] - s.Position.x, dz = p[2] - s.Position.z;
+
+        // float rounding in every step, growing with the distances involved; a step too many or
+        // too few moves the impact by the distance covered in one step, far above this
+        double scale = 1.0 + std::fabs(s.Position.y) + std::fabs(settings.GroundY) + (std::sqrt(speed) + std::sqrt(gravity) * t) * t;
+        double bound = 2.0 * (steps + 1.0) * FLT_EPSILON * scale;
+        double error = std::max(std::fabs(p[1] - settings.GroundY), std::fabs(std::sqrt(dx * dx + dz * dz) - results[i].Range)) / bound;
+        worst = std::max(worst, error);
+        if (error > 1.0)
+            mismatches++;
+        checked++;
+    }
+    std::cout << "[Sweep] closed form:    " << (mismatches ? "MISMATCH in " : "matches, ") << (mismatches ? mismatches : checked)
+              << " landings (worst error " << worst << " of the bound)" << std::endl;
+    return mismatches == 0 && checked > 0;
+}
+
+// the same sweep on one thread must give bit-identical results, whatever ran first
+static bool CheckThreadIndependent(const std::vector<SweepScenario>& scenarios, const std::vector<SweepResult>& results, SweepSettings settings, unsigned int threads)
+{
+    if (threads < 2)
+    {
+        std::cout << "[Sweep] thread check:   needs a run on more than one thread (more than 64 scenarios, --threads > 1)" << std::endl;
+        return false;
+    }
+    std::vector<SweepResult> serial;
+    settings.ThreadCount = 1;
+    RunSweep(scenarios, serial, settings);
+    uint64_t expected = HashSweepResults(serial), actual = HashSweepResults(results);
+    std::cout << "[Sweep] thread check:   " << threads << " threads " << std::hex << actual << ", 1 thread " << expected << std::dec
+              << (actual == expected ? " (identical)" : " (MISMATCH)") << std::endl;
+    return actual == expected;
+}
+
+int main(int argc, char** argv)
+{
+    // axis order matches the list file columns; defaults are the demo scene
+    const char* axisNames[11] = { "--px", "--py", "--pz", "--vx", "--vy", "--vz", "--beta", "--mass", "--gx", "--gy", "--gz" };
+    std::vector<float> axes[11] = { { 0.0f }, { 10.0f }, { 0.0f }, { 5.0f }, { 0.0f }, { 0.0f }, { 0.5f }, { 1.0f }, { 0.0f }, { -5.0f }, { 0.0f } };
+    std::string listPath, outPath;
+    SweepSettings settings;
+    bool check = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool parsed = false;
+        for (int axis = 0; axis < 11 && !parsed; axis++)
+        {
+            if (std::strcmp(argv[i], axisNames[axis]) == 0 && i + 1 < argc)
+            {
+                if (!ParseValues(argv[++i], axes[axis]))
+                {
+                    std::cout << "Bad values for " << axisNames[axis] << ": " << argv[i] << std::endl;
+                    return 1;
+                }
+                parsed = true;
+            }
+        }
+        if (parsed)
+            continue;
+
+        if (std::strcmp(argv[i], "--list") == 0 && i + 1 < argc)
+            listPath = argv[++i];
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            outPath = argv[++i];
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            settings.ThreadCount = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--dt") == 0 && i + 1 < argc)
+            settings.Dt = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--ground") == 0 && i + 1 < argc)
+            settings.GroundY = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--max-time") == 0 && i + 1 < argc)
+            settings.MaxTime = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--check") == 0)
+            check = true;
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (settings.Dt <= 0.0f)
+    {
+        std::cout << "--dt must be positive" << std::endl;
+        return 1;
+    }
+
+    std::vector<SweepScenario> scenarios;
+    if (!listPath.empty())
+    {
+        if (!ReadScenarioList(listPath, scenarios))
+        {
+            std::cout << "Failed to read " << listPath << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        size_t total = 1;
+        for (const std::vector<float>& axis : axes)
+            total *= axis.size();
+        scenarios.reserve(total);
+        for (size_t index = 0; index < total; index++)
+        {
+            // mixed-radix decomposition, last axis fastest
+            float v[11];
+            size_t rest = index;
+            for (int axis = 10; axis >= 0; axis--)
+            {
+                v[axis] = axes[axis][rest % axes[axis].size()];
+                rest /= axes[axis].size();
+            }
+            SweepScenario s;
+            s.Position = Vec3(v[0], v[1], v[2]);
+            s.Velocity = Vec3(v[3], v[4], v[5]);
+            s.Params.Beta = v[6];
+            s.Params.Mass = v[7];
+            s.Params.Gravity = Vec3(v[8], v[9], v[10]);
+            scenarios.push_back(s);
+        }
+    }
+
+    std::vector<SweepResult> results;
+    auto start = std::chrono::steady_clock::now();
+    unsigned int threads = RunSweep(scenarios, results, settings);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t landed = 0, farthest = 0;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        landed += results[i].Landed ? 1 : 0;
+        if (results[i].Range > results[farthest].Range)
+            farthest = i;
+    }
+
+    std::cout << "[Sweep] scenarios:      " << scenarios.size() << " (" << landed << " landed)" << std::endl;
+    std::cout << "[Sweep] threads:        " << threads << std::endl;
+    std::cout << "[Sweep] total:          " << ms << " ms" << std::endl;
+    std::cout << "[Sweep] scenarios/sec:  " << (ms > 0.0 ? scenarios.size() * 1000.0 / ms : 0.0) << std::endl;
+    std::cout << "[Sweep] results hash:   " << std::hex << HashSweepResults(results) << std::dec << std::endl;
+    if (!results.empty())
+    {
+        const SweepScenario& s = scenarios[farthest];
+        std::cout << "[Sweep] longest range:  " << results[farthest].Range << " (v " << s.Velocity.x << " " << s.Velocity.y << " " << s.Velocity.z
+                  << ", beta " << s.Params.Beta << ", mass " << s.Params.Mass << ")" << std::endl;
+    }
+
+    if (!outPath.empty())
+    {
+        bool binary = outPath.size() >= 4 && outPath.compare(outPath.size() - 4, 4, ".bin") == 0;
+        bool written = binary ? WriteSweepBinary(outPath, scenarios, results) : WriteSweepCsv(outPath, scenarios, results);
+        if (!written)
+        {
+            std::cout << "Failed to write " << outPath << std::endl;
+            return 1;
+        }
+        std::cout << "[Sweep] written:        " << outPath << std::endl;
+    }
+
+    if (check && (!CheckAgainstClosedForm(scenarios, results, settings) || !CheckThreadIndependent(scenarios, results, settings, threads)))
+        return 1;
+    return 0;
+}
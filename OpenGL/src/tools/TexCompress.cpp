@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "renderer/MappedFile.h"
+#include "renderer/TextureCache.h"
+#include "renderer/TextureCompression.h"
+#include "renderer/TextureImage.h"
+
+/* Offline texture compressor: ball_texcompress [--check [--min-psnr DB]] <image>...
+   Writes "<image>.bc1" with a BC1 mip chain next to each source; the
+   loader picks it up while the source hash still matches.
+   --check writes nothing next to the sources. It bounds the encoder's
+   error per texel on a synthetic gradient, decodes hand-built blocks
+   against the BC1 spec (the fallback used without S3TC), and for each
+   image reports the BC1 round-trip PSNR of its worst mip level (failing
+   below --min-psnr) and round-trips the RAW and BC1 images through a
+   cache file in the temp directory, which must then be rejected under a
+   stale hash or when truncated. */
+
+// PSNR over RGB of a decoded BC1 level against the source level it came from
+static double LevelPsnr(const TextureImage& source, const TextureImage& decoded, size_t level)
+{
+    const MipLevel& mip = source.Levels[level];
+    const unsigned char* a = source.LevelData(level);
+    const unsigned char* b = decoded.LevelData(level);
+    size_t pixels = (size_t)mip.Width * mip.Height;
+    double squared = 0.0;
+    for (size_t p = 0; p < pixels; p++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            double d = (double)a[p * source.Channels + c] - b[p * 3 + c];
+            squared += d * d;
+        }
+    }
+    double mse = squared / (pixels * 3);
+    return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+}
+
+/* Decodes single 4x4 blocks whose expected texels follow from the BC1
+   spec alone: texel p uses index p % 4; c0 > c1 selects the four-colour
+   palette, c0 <= c1 the three-colour one with black. */
+static bool CheckBlockDecode()
+{
+    struct Case
+    {
+        uint16_t C0, C1;
+        int Expected[4][3];
+    };
+    const Case cases[] = {
+        { 0xF800, 0x001F, { { 255, 0, 0 }, { 0, 0, 255 }, { 170, 0, 85 }, { 85, 0, 170 } } },
+        { 0x001F, 0xF800, { { 0, 0, 255 }, { 255, 0, 0 }, { 127, 0, 127 }, { 0, 0, 0 } } },
+    };
+
+    bool ok = true;
+    for (const Case& test : cases)
+    {
+        TextureImage block;
+        block.Width = block.Height = 4;
+        block.Channels = 3;
+        block.Format = TextureFormat::BC1;
+        block.Storage.Resize(8);
+        block.Levels.push_back({ 4, 4, 0, 8 });
+        unsigned char* bytes = block.Storage.Data();
+        bytes[0] = (unsigned char)(test.C0 & 0xFF);
+        bytes[1] = (unsigned char)(test.C0 >> 8);
+        bytes[2] = (unsigned char)(test.C1 & 0xFF);
+        bytes[3] = (unsigned char)(test.C1 >> 8);
+        std::memset(bytes + 4, 0xE4, 4); // indices 0, 1, 2, 3 in every row
+
+        TextureImage decoded;
+        if (!DecompressBC1(block, decoded))
+        {
+            ok = false;
+            continue;
+        }
+        for (int p = 0; p < 16; p++)
+            for (int c = 0; c < 3; c++)
+                if (decoded.LevelData(0)[p * 3 + c] != test.Expected[p % 4][c])
+                    ok = false;
+    }
+    std::cout << "[TexCompress] BC1 block decode: " << (ok ? "ok" : "MISMATCH") << std::endl;
+    return ok;
+}
+
+/* A gradient along one direction puts every 4x4 block of every mip level
+   on a line in RGB, which BC1's palette represents up to the 5:6:5 endpoint rounding
+   (about 4 per channel, plus 1 for the integer blends) and half the gap
+   between palette entries (a sixth of the block's range). */
+static bool CheckGradient()
+{
+    const int SIZE = 64;
+    TextureImage image;
+    image.Width = image.Height = SIZE;
+    image.Channels = 3;
+    image.Storage.Resize((size_t)SIZE * SIZE * 3);
+    image.Levels.push_back({ SIZE, SIZE, 0, (size_t)SIZE * SIZE * 3 });
+    unsigned char* pixels = image.Storage.Data();
+    for (int y = 0; y < SIZE; y++)
+    {
+        for (int x = 0; x < SIZE; x++)
+        {
+            unsigned char* p = pixels + ((size_t)y * SIZE + x) * 3;
+            // all three channels follow t = x + y, so each block's colours are collinear
+            p[0] = (unsigned char)(2 * (x + y));
+            p[1] = (unsigned char)(255 - 2 * (x + y));
+            p[2] = (unsigned char)(x + y);
+        }
+    }
+
+    TextureImage compressed, decoded;
+    if (!BuildMipChain(image) || !CompressBC1(image, compressed) || !DecompressBC1(compressed, decoded))
+    {
+        std::cout << "[TexCompress] gradient: BC1 round trip failed" << std::endl;
+        return false;
+    }
+
+    unsigned int over = 0;
+    double worst = 0.0; // largest error relative to its bound
+    for (size_t l = 0; l < image.Levels.size(); l++)
+    {
+        const MipLevel& mip = image.Levels[l];
+        const unsigned char* a = image.LevelData(l);
+        const unsigned char* b = decoded.LevelData(l);
+        for (int by = 0; by < mip.Height; by += 4)
+        {
+            for (int bx = 0; bx < mip.Width; bx += 4)
+            {
+                int lo[3] = { 255, 255, 255 }, hi[3] = { 0, 0, 0 };
+                for (int y = by; y < std::min(by + 4, mip.Height); y++)
+                    for (int x = bx; x < std::min(bx + 4, mip.Width); x++)
+                        for (int c = 0; c < 3; c++)
+                        {
+                            lo[c] = std::min(lo[c], (int)a[((size_t)y * mip.Width + x) * 3 + c]);
+                            hi[c] = std::max(hi[c], (int)a[((size_t)y * mip.Width + x) * 3 + c]);
+                        }
+                for (int y = by; y < std::min(by + 4, mip.Height); y++)
+                    for (int x = bx; x < std::min(bx + 4, mip.Width); x++)
+                        for (int c = 0; c < 3; c++)
+                        {
+                            size_t i = ((size_t)y * mip.Width + x) * 3 + c;
+                            double bound = 5.0 + (hi[c] - lo[c]) / 6.0;
+                            double error = std::abs((int)a[i] - (int)b[i]);
+                            worst = std::max(worst, error / bound);
+                            if (error > bound)
+                                over++;
+                        }
+            }
+        }
+    }
+    std::cout << "[TexCompress] gradient: " << image.Levels.size() << " levels, worst texel at " << worst << " of its bound"
+              << (over == 0 ? "" : ", MISMATCH") << std::endl;
+    return over == 0;
+}
+
+static bool SameImage(const TextureImage& a, const TextureImage& b)
+{
+    if (a.Width != b.Width || a.Height != b.Height || a.Channels != b.Channels || a.Format != b.Format
+        || a.Origin != b.Origin || a.Levels.size() != b.Levels.size())
+        return false;
+    for (size_t l = 0; l < a.Levels.size(); l++)
+    {
+        const MipLevel& x = a.Levels[l];
+        const MipLevel& y = b.Levels[l];
+        if (x.Width != y.Width || x.Height != y.Height || x.Size != y.Size
+            || std::memcmp(a.LevelData(l), b.LevelData(l), x.Size) != 0)
+            return false;
+    }
+    return true;
+}
+
+static bool WriteBytes(const std::string& path, const unsigned char* data, size_t size)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write((const char*)data, (std::streamsize)size);
+    return (bool)out;
+}
+
+/* Writes image to a cache file, maps it back and compares; then the same
+   file must miss under another source hash and when cut short anywhere
+   from the header to the last byte of pixels. */
+static bool CheckCacheRoundTrip(const std::string& label, const TextureImage& image, uint64_t hash, const std::string& path)
+{
+    TextureImage readBack;
+    bool roundTrip = WriteTextureFile(path, hash, image) && ReadTextureFile(path, hash, readBack) && SameImage(image, readBack);
+    readBack = TextureImage();
+
+    TextureImage stale;
+    bool staleRejected = !ReadTextureFile(path, hash + 1, stale);
+
+    int truncatedAccepted = 0;
+    MappedFile file;
+    if (file.Open(path))
+    {
+        const std::string cutPath = path + ".cut";
+        const size_t cuts[] = { 0, 16, file.Size() / 3, file.Size() / 2, file.Size() - 1 };
+        for (size_t size : cuts)
+        {
+            TextureImage truncated;
+            if (WriteBytes(cutPath, file.Data(), size) && ReadTextureFile(cutPath, hash, truncated))
+                truncatedAccepted++;
+        }
+        std::error_code ec;
+        std::filesystem::remove(cutPath, ec);
+    }
+    else
+        roundTrip = false;
+    file.Close();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+
+    bool ok = roundTrip && staleRejected && truncatedAccepted == 0;
+    std::cout << "[TexCompress] " << label << " cache file: round trip " << (roundTrip ? "identical" : "MISMATCH")
+              << ", stale hash " << (staleRejected ? "rejected" : "ACCEPTED")
+              << ", truncated " << (truncatedAccepted == 0 ? "rejected" : "ACCEPTED") << std::endl;
+    return ok;
+}
+
+// --check for one source image, nothing written next to it
+static bool CheckImage(const std::string& path, const TextureImage& image, const TextureImage& compressed, uint64_t hash, double minPsnr)
+{
+    TextureImage decoded;
+    bool ok = DecompressBC1(compressed, decoded) && decoded.Levels.size() == image.Levels.size();
+    double worst = 99.0;
+    for (size_t l = 0; ok && l < image.Levels.size(); l++)
+        worst = std::min(worst, LevelPsnr(image, decoded, l));
+    ok = ok && worst >= minPsnr;
+    std::cout << "[TexCompress] " << path << ": BC1 round trip, worst level " << worst << " dB"
+              << (ok ? "" : " MISMATCH") << std::endl;
+
+    std::string cachePath = (std::filesystem::temp_directory_path() / ("ball_texcompress_check_" + std::filesystem::path(path).filename().string())).string();
+    ok = CheckCacheRoundTrip(path + " RAW", image, hash, cachePath) && ok;
+    ok = CheckCacheRoundTrip(path + " BC1", compressed, hash, cachePath) && ok;
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    bool check = false;
+    double minPsnr = 0.0;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--check") == 0)
+            check = true;
+        else if (std::strcmp(argv[i], "--min-psnr") == 0 && i + 1 < argc)
+            minPsnr = std::atof(argv[++i]);
+        else
+            files.push_back(argv[i]);
+    }
+    if (files.empty())
+    {
+        std::cout << "usage: " << argv[0] << " [--check [--min-psnr DB]] <image>..." << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    if (check && !CheckBlockDecode())
+        failures++;
+    if (check && !CheckGradient())
+        failures++;
+    for (const std::string& path : files)
+    {
+        uint64_t hash = 0;
+        TextureImage image, compressed;
+        if (!HashSourceFile(path, hash) || !DecodeImage(path, image))
+        {
+            std::cout << "Failed to load " << path << std::endl;
+            failures++;
+            continue;
+        }
+        // the decoder pads RGB to RGBA, only the file says whether alpha is real
+        if (image.FileChannels == 4 || image.FileChannels == 2)
+            std::cout << "Warning: " << path << " has alpha, BC1 output is opaque" << std::endl;
+
+        if (!CompressBC1(image, compressed) || (!check && !WriteTextureFile(CompressedTexturePath(path), hash, compressed)))
+        {
+            std::cout << "Failed to compress " << path << std::endl;
+            failures++;
+            continue;
+        }
+        if (check)
+        {
+            if (!CheckImage(path, image, compressed, hash, minPsnr))
+                failures++;
+            continue;
+        }
+
+        // against the source's own channel count, not the padded decode
+        size_t rawSize = 0;
+        for (const MipLevel& level : image.Levels)
+            rawSize += LevelSize(TextureFormat::RAW, image.FileChannels, level.Width, level.Height);
+        size_t bc1Size = compressed.Levels.back().Offset + compressed.Levels.back().Size;
+        std::cout << path << ": " << rawSize << " -> " << bc1Size << " bytes ("
+                  << (double)rawSize / bc1Size << "x)" << std::endl;
+    }
+
+    return failures == 0 ? 0 : 1;
+}